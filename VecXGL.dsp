@@ -93,6 +93,10 @@ SOURCE=.\e6809.c
 # End Source File
 # Begin Source File
 
+SOURCE=.\glrender.c
+# End Source File
+# Begin Source File
+
 SOURCE=.\osint.c
 # End Source File
 # Begin Source File
@@ -109,6 +113,10 @@ SOURCE=.\e6809.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\glrender.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\osint.h
 # End Source File
 # Begin Source File
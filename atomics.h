@@ -0,0 +1,30 @@
+#ifndef __ATOMICS_H
+#define __ATOMICS_H
+
+/* the few lock-free primitives needed to pass frames and input between the
+ * emulation thread and the main thread. counters are volatile longs, exchanges
+ * operate on void pointers. all operations are full acquire/release
+ * barriers.
+ */
+
+#if defined (_MSC_VER)
+
+#include <windows.h>
+
+#define atomic_inc(p)			InterlockedIncrement (p)
+#define atomic_dec(p)			InterlockedDecrement (p)
+#define atomic_load(p)			InterlockedCompareExchange (p, 0, 0)
+#define atomic_store(p, v)		InterlockedExchange (p, v)
+#define atomic_xchg_ptr(p, v)	InterlockedExchangePointer (p, v)
+
+#else
+
+#define atomic_inc(p)			__atomic_add_fetch (p, 1, __ATOMIC_ACQ_REL)
+#define atomic_dec(p)			__atomic_sub_fetch (p, 1, __ATOMIC_ACQ_REL)
+#define atomic_load(p)			__atomic_load_n (p, __ATOMIC_ACQUIRE)
+#define atomic_store(p, v)		__atomic_store_n (p, v, __ATOMIC_RELEASE)
+#define atomic_xchg_ptr(p, v)	__atomic_exchange_n (p, v, __ATOMIC_ACQ_REL)
+
+#endif
+
+#endif
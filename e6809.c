@@ -1,6 +1,20 @@
 #include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include "e6809.h"
 
+/* the block compiler emits x86-64 code */
+
+#if defined (__x86_64__) || defined (_M_X64)
+#define E6809_JIT
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
 /* code assumptions:
  *  - it is assumed that an 'int' is at least 16 bits long.
  *  - a 16-bit register has valid bits only in the lower 16 bits and an
@@ -23,70 +37,85 @@ enum {
 	FLAG_C		= 0x01,
 	IRQ_NORMAL	= 0,
 	IRQ_SYNC	= 1,
-	IRQ_CWAI	= 2
+	IRQ_CWAI	= 2,
+	CC_SUB		= 1,	/* lazy flags were produced by a subtraction */
+	CC_16		= 2,	/* lazy flags were produced by a 16-bit operation */
+	CC_ARITH	= FLAG_H | FLAG_N | FLAG_Z | FLAG_V | FLAG_C
 };
 
-/* index registers */
-
-static unsigned reg_x;
-static unsigned reg_y;
-
-/* user stack pointer */
-
-static unsigned reg_u;
-
-/* hardware stack pointer */
-
-static unsigned reg_s;
-
-/* program counter */
+/* index registers selected by bits 5-6 of an indexed post byte */
 
-static unsigned reg_pc;
+static const size_t rptr_xyus_off[4] = {
+	offsetof (e6809_t, reg_x),
+	offsetof (e6809_t, reg_y),
+	offsetof (e6809_t, reg_u),
+	offsetof (e6809_t, reg_s)
+};
 
-/* accumulators */
+static einline unsigned *rptr_xyus (e6809_t *c, unsigned r)
+{
+	return (unsigned *) ((char *) c + rptr_xyus_off[r]);
+}
 
-static unsigned reg_a;
-static unsigned reg_b;
+/* flags for pcs the host has told us about */
 
-/* direct page register */
+enum {
+	PC_IDLE		= 0x01, /* start of an idle loop */
+	PC_HLE		= 0x02  /* entry of a routine the host emulates */
+};
 
-static unsigned reg_dp;
+/* flags of a pc the host has told us about, 0 for any other pc */
 
-/* condition codes */
+static einline unsigned pc_flags (e6809_t *c, unsigned pc)
+{
+	unsigned m;
 
-static unsigned reg_cc;
+	pc &= 0xffff;
 
-/* flag to see if interrupts should be handled (sync/cwai). */
+	if (c->pc_page[pc >> 8] == 0) {
+		return 0;
+	}
 
-static unsigned irq_status;
+	for (m = 0; m < c->pc_marks && c->pc_mark[m] <= pc; m++) {
+		if (c->pc_mark[m] == pc) {
+			return c->pc_mark_flags[m];
+		}
+	}
 
-static unsigned *rptr_xyus[4] = {
-	&reg_x,
-	&reg_y,
-	&reg_u,
-	&reg_s
-};
+	return 0;
+}
 
-/* user defined read and write functions */
+/* idle loop detection. after a backward jump of at most IDLE_SPAN bytes
+ * (or a step that lands on a known idle pc) the cpu state is recorded in
+ * idle_regs. when the same state comes around again without any write to
+ * memory in between, the cpu is spinning in a loop whose only inputs are
+ * the trapped reads listed in idle_addr/idle_data.
+ */
 
-unsigned char (*e6809_read8) (unsigned address);
-void (*e6809_write8) (unsigned address, unsigned char data);
+#define IDLE_SPAN 32
+#define IDLE_READS E6809_IDLE_READS
+#define IDLE_REGS E6809_IDLE_REGS
+#define IDLE_NONE 0x10000
 
-/* obtain a particular condition code. returns 0 or 1. */
+/* bring the peripherals up to the start of the current step (or of the
+ * current instruction of a compiled block) before it touches them.
+ */
 
-static einline unsigned get_cc (unsigned flag)
+static void run_sync (e6809_t *c)
 {
-	return (reg_cc / flag) & 1;
-}
+	unsigned cycles;
 
-/* set a particular condition code to either 0 or 1.
- * value parameter must be either 0 or 1.
- */
+	c->run_io = 1;
+	cycles = c->run_base;
 
-static einline void set_cc (unsigned flag, unsigned value)
-{
-	reg_cc &= ~flag;
-	reg_cc |= value * flag;
+	if (c->jit_running) {
+		c->jit_io = 1;
+		cycles += c->jit_start;
+	}
+
+	if (c->sync != NULL) {
+		(*c->sync) (c->user, cycles);
+	}
 }
 
 /* test carry */
@@ -156,103 +185,256 @@ static einline unsigned test_v (unsigned i0, unsigned i1, unsigned r)
 	return flag;
 }
 
-static einline unsigned get_reg_d (void)
+/* derive one of the lazy flags from the last recorded operation */
+
+static einline unsigned cc_eval (e6809_t *c, unsigned flag)
+{
+	unsigned shift;
+
+	shift = (c->cc_kind & CC_16) ? 8 : 0;
+
+	switch (flag) {
+	case FLAG_H:
+		return test_c (c->cc_i0 << 4, c->cc_i1 << 4, c->cc_r << 4, 0);
+	case FLAG_N:
+		return test_n (c->cc_r >> shift);
+	case FLAG_Z:
+		return shift ? test_z16 (c->cc_r) : test_z8 (c->cc_r);
+	case FLAG_V:
+		return test_v (c->cc_i0 >> shift, c->cc_i1 >> shift, c->cc_r >> shift);
+	default:
+		return test_c (c->cc_i0 >> shift, c->cc_i1 >> shift, c->cc_r >> shift,
+					   c->cc_kind & CC_SUB);
+	}
+}
+
+/* move all lazy flags into reg_cc */
+
+static void cc_flush (e6809_t *c)
+{
+	unsigned flag;
+
+	for (flag = FLAG_C; flag <= FLAG_H; flag <<= 1) {
+		if (c->cc_lazy & flag) {
+			c->reg_cc &= ~flag;
+			c->reg_cc |= cc_eval (c, flag) * flag;
+		}
+	}
+
+	c->cc_lazy = 0;
+}
+
+/* record an operation whose result defines the flags in mask */
+
+static einline void cc_record (e6809_t *c, unsigned kind, unsigned mask,
+							   unsigned i0, unsigned i1, unsigned r)
+{
+	if (c->cc_lazy & ~mask) {
+		cc_flush (c);
+	}
+
+	c->cc_lazy = mask;
+	c->cc_kind = kind;
+	c->cc_i0 = i0;
+	c->cc_i1 = i1;
+	c->cc_r = r;
+}
+
+/* obtain a particular condition code. returns 0 or 1. */
+
+static einline unsigned get_cc (e6809_t *c, unsigned flag)
+{
+	if (c->cc_lazy & flag) {
+		return cc_eval (c, flag);
+	}
+
+	return (c->reg_cc / flag) & 1;
+}
+
+/* set a particular condition code to either 0 or 1.
+ * value parameter must be either 0 or 1.
+ */
+
+static einline void set_cc (e6809_t *c, unsigned flag, unsigned value)
+{
+	c->cc_lazy &= ~flag;
+	c->reg_cc &= ~flag;
+	c->reg_cc |= value * flag;
+}
+
+/* the whole condition code register */
+
+static einline unsigned get_reg_cc (e6809_t *c)
+{
+	if (c->cc_lazy) {
+		cc_flush (c);
+	}
+
+	return c->reg_cc;
+}
+
+static einline void set_reg_cc (e6809_t *c, unsigned value)
+{
+	c->cc_lazy = 0;
+	c->reg_cc = value;
+}
+
+static einline unsigned get_reg_d (e6809_t *c)
+{
+	return (c->reg_a << 8) | (c->reg_b & 0xff);
+}
+
+static einline void set_reg_d (e6809_t *c, unsigned value)
 {
-	return (reg_a << 8) | (reg_b & 0xff);
+	c->reg_a = value >> 8;
+	c->reg_b = value;
 }
 
-static einline void set_reg_d (unsigned value)
+/* note a trapped read made inside e6809_run for idle loop detection. a loop
+ * reading more distinct addresses than fit, or reading the same address
+ * twice with different results, is not idle.
+ */
+
+static unsigned idle_read (e6809_t *c, unsigned address, unsigned data)
 {
-	reg_a = value >> 8;
-	reg_b = value;
+	unsigned i;
+
+	for (i = 0; i < c->idle_naddr; i++) {
+		if (c->idle_addr[i] == address) {
+			if (c->idle_data[i] != data) {
+				c->idle_dirty = 1;
+			}
+
+			return data;
+		}
+	}
+
+	if (c->idle_naddr < IDLE_READS) {
+		c->idle_addr[c->idle_naddr] = address;
+		c->idle_data[c->idle_naddr] = (unsigned char) data;
+		c->idle_naddr++;
+	} else {
+		c->idle_dirty = 1;
+	}
+
+	return data;
 }
 
 /* read a byte ... the returned value has the lower 8-bits set to the byte
  * while the upper bits are all zero.
  */
 
-static einline unsigned read8 (unsigned address)
+static einline unsigned read8 (e6809_t *c, unsigned address)
 {
-	return (*e6809_read8) (address & 0xffff);
+	const unsigned char *page;
+
+	address &= 0xffff;
+	page = c->rmap[address >> 8];
+
+	if (page != NULL) {
+		return page[address & 0xff];
+	}
+
+	if (c->run_active) {
+		run_sync (c);
+		return idle_read (c, address, (*c->read8) (c->user, address));
+	}
+
+	return (*c->read8) (c->user, address);
 }
 
 /* write a byte ... only the lower 8-bits of the unsigned data
  * is written. the upper bits are ignored.
  */
 
-static einline void write8 (unsigned address, unsigned data)
+static einline void write8 (e6809_t *c, unsigned address, unsigned data)
 {
-	(*e6809_write8) (address & 0xffff, (unsigned char) data);
+	unsigned char *page;
+
+	address &= 0xffff;
+	page = c->wmap[address >> 8];
+
+	c->idle_dirty = 1;
+
+	if (page != NULL) {
+		page[address & 0xff] = (unsigned char) data;
+	} else {
+		if (c->run_active) {
+			run_sync (c);
+		}
+
+		(*c->write8) (c->user, address, (unsigned char) data);
+	}
 }
 
-static einline unsigned read16 (unsigned address)
+static einline unsigned read16 (e6809_t *c, unsigned address)
 {
 	unsigned datahi, datalo;
 
-	datahi = read8 (address);
-	datalo = read8 (address + 1);
+	datahi = read8 (c, address);
+	datalo = read8 (c, address + 1);
 
 	return (datahi << 8) | datalo;
 }
 
-static einline void write16 (unsigned address, unsigned data)
+static einline void write16 (e6809_t *c, unsigned address, unsigned data)
 {
-	write8 (address, data >> 8);
-	write8 (address + 1, data);
+	write8 (c, address, data >> 8);
+	write8 (c, address + 1, data);
 }
 
-static einline void push8 (unsigned *sp, unsigned data)
+static einline void push8 (e6809_t *c, unsigned *sp, unsigned data)
 {
 	(*sp)--;
-	write8 (*sp, data);
+	write8 (c, *sp, data);
 }
 
-static einline unsigned pull8 (unsigned *sp)
+static einline unsigned pull8 (e6809_t *c, unsigned *sp)
 {
 	unsigned data;
 
-	data = read8 (*sp);
+	data = read8 (c, *sp);
 	(*sp)++;
 
 	return data;
 }
 
-static einline void push16 (unsigned *sp, unsigned data)
+static einline void push16 (e6809_t *c, unsigned *sp, unsigned data)
 {
-	push8 (sp, data);
-	push8 (sp, data >> 8);
+	push8 (c, sp, data);
+	push8 (c, sp, data >> 8);
 }
 
-static einline unsigned pull16 (unsigned *sp)
+static einline unsigned pull16 (e6809_t *c, unsigned *sp)
 {
 	unsigned datahi, datalo;
 
-	datahi = pull8 (sp);
-	datalo = pull8 (sp);
+	datahi = pull8 (c, sp);
+	datalo = pull8 (c, sp);
 
 	return (datahi << 8) | datalo;
 }
 
 /* read a byte from the address pointed to by the pc */
 
-static einline unsigned pc_read8 (void)
+static einline unsigned pc_read8 (e6809_t *c)
 {
 	unsigned data;
 
-	data = read8 (reg_pc);
-	reg_pc++;
+	data = read8 (c, c->reg_pc);
+	c->reg_pc++;
 
 	return data;
 }
 
 /* read a word from the address pointed to by the pc */
 
-static einline unsigned pc_read16 (void)
+static einline unsigned pc_read16 (e6809_t *c)
 {
 	unsigned data;
 
-	data = read16 (reg_pc);
-	reg_pc += 2;
+	data = read16 (c, c->reg_pc);
+	c->reg_pc += 2;
 
 	return data;
 }
@@ -269,29 +451,29 @@ static einline unsigned sign_extend (unsigned data)
  * instruction itself.
  */
 
-static einline unsigned ea_direct (void)
+static einline unsigned ea_direct (e6809_t *c)
 {
-	return (reg_dp << 8) | pc_read8 ();
+	return (c->reg_dp << 8) | pc_read8 (c);
 }
 
 /* extended addressing, address is obtained from 2 bytes following
  * the instruction.
  */
 
-static einline unsigned ea_extended (void)
+static einline unsigned ea_extended (e6809_t *c)
 {
-	return pc_read16 ();
+	return pc_read16 (c);
 }
 
 /* indexed addressing */
 
-static einline unsigned ea_indexed (unsigned *cycles)
+static einline unsigned ea_indexed (e6809_t *c, unsigned *cycles)
 {
 	unsigned r, op, ea;
 
 	/* post byte */
 
-	op = pc_read8 ();
+	op = pc_read8 (c);
 
 	r = (op >> 5) & 3;
 
@@ -314,7 +496,7 @@ static einline unsigned ea_indexed (unsigned *cycles)
 	case 0x6c: case 0x6d: case 0x6e: case 0x6f:
 		/* R, +[0, 15] */
 
-		ea = *rptr_xyus[r] + (op & 0xf);
+		ea = *rptr_xyus (c, r) + (op & 0xf);
 		(*cycles)++;
 		break;
 	case 0x10: case 0x11: case 0x12: case 0x13:
@@ -335,7 +517,7 @@ static einline unsigned ea_indexed (unsigned *cycles)
 	case 0x7c: case 0x7d: case 0x7e: case 0x7f:
 		/* R, +[-16, -1] */
 
-		ea = *rptr_xyus[r] + (op & 0xf) - 0x10;
+		ea = *rptr_xyus (c, r) + (op & 0xf) - 0x10;
 		(*cycles)++;
 		break;
 	case 0x80: case 0x81:
@@ -344,8 +526,8 @@ static einline unsigned ea_indexed (unsigned *cycles)
 	case 0xe0: case 0xe1:
 		/* ,R+ / ,R++ */
 
-		ea = *rptr_xyus[r];
-		*rptr_xyus[r] += 1 + (op & 1);
+		ea = *rptr_xyus (c, r);
+		*rptr_xyus (c, r) += 1 + (op & 1);
 		*cycles += 2 + (op & 1);
 		break;
 	case 0x90: case 0x91:
@@ -354,8 +536,8 @@ static einline unsigned ea_indexed (unsigned *cycles)
 	case 0xf0: case 0xf1:
 		/* [,R+] ??? / [,R++] */
 
-		ea = read16 (*rptr_xyus[r]);
-		*rptr_xyus[r] += 1 + (op & 1);
+		ea = read16 (c, *rptr_xyus (c, r));
+		*rptr_xyus (c, r) += 1 + (op & 1);
 		*cycles += 5 + (op & 1);
 		break;
 	case 0x82: case 0x83:
@@ -365,8 +547,8 @@ static einline unsigned ea_indexed (unsigned *cycles)
 
 		/* ,-R / ,--R */
 
-		*rptr_xyus[r] -= 1 + (op & 1);
-		ea = *rptr_xyus[r];
+		*rptr_xyus (c, r) -= 1 + (op & 1);
+		ea = *rptr_xyus (c, r);
 		*cycles += 2 + (op & 1);
 		break;
 	case 0x92: case 0x93:
@@ -375,133 +557,134 @@ static einline unsigned ea_indexed (unsigned *cycles)
 	case 0xf2: case 0xf3:
 		/* [,-R] ??? / [,--R] */
 
-		*rptr_xyus[r] -= 1 + (op & 1);
-		ea = read16 (*rptr_xyus[r]);
+		*rptr_xyus (c, r) -= 1 + (op & 1);
+		ea = read16 (c, *rptr_xyus (c, r));
 		*cycles += 5 + (op & 1);
 		break;
 	case 0x84: case 0xa4:
 	case 0xc4: case 0xe4:
 		/* ,R */
 
-		ea = *rptr_xyus[r];
+		ea = *rptr_xyus (c, r);
 		break;
 	case 0x94: case 0xb4:
 	case 0xd4: case 0xf4:
 		/* [,R] */
 
-		ea = read16 (*rptr_xyus[r]);
+		ea = read16 (c, *rptr_xyus (c, r));
 		*cycles += 3;
 		break;
 	case 0x85: case 0xa5:
 	case 0xc5: case 0xe5:
 		/* B,R */
 
-		ea = *rptr_xyus[r] + sign_extend (reg_b);
+		ea = *rptr_xyus (c, r) + sign_extend (c->reg_b);
 		*cycles += 1;
 		break;
 	case 0x95: case 0xb5:
 	case 0xd5: case 0xf5:
 		/* [B,R] */
 
-		ea = read16 (*rptr_xyus[r] + sign_extend (reg_b));
+		ea = read16 (c, *rptr_xyus (c, r) + sign_extend (c->reg_b));
 		*cycles += 4;
 		break;
 	case 0x86: case 0xa6:
 	case 0xc6: case 0xe6:
 		/* A,R */
 
-		ea = *rptr_xyus[r] + sign_extend (reg_a);
+		ea = *rptr_xyus (c, r) + sign_extend (c->reg_a);
 		*cycles += 1;
 		break;
 	case 0x96: case 0xb6:
 	case 0xd6: case 0xf6:
 		/* [A,R] */
 
-		ea = read16 (*rptr_xyus[r] + sign_extend (reg_a));
+		ea = read16 (c, *rptr_xyus (c, r) + sign_extend (c->reg_a));
 		*cycles += 4;
 		break;
 	case 0x88: case 0xa8:
 	case 0xc8: case 0xe8:
 		/* byte,R */
 
-		ea = *rptr_xyus[r] + sign_extend (pc_read8 ());
+		ea = *rptr_xyus (c, r) + sign_extend (pc_read8 (c));
 		*cycles += 1;
 		break;
 	case 0x98: case 0xb8:
 	case 0xd8: case 0xf8:
 		/* [byte,R] */
 
-		ea = read16 (*rptr_xyus[r] + sign_extend (pc_read8 ()));
+		ea = read16 (c, *rptr_xyus (c, r) + sign_extend (pc_read8 (c)));
 		*cycles += 4;
 		break;
 	case 0x89: case 0xa9:
 	case 0xc9: case 0xe9:
 		/* word,R */
 
-		ea = *rptr_xyus[r] + pc_read16 ();
+		ea = *rptr_xyus (c, r) + pc_read16 (c);
 		*cycles += 4;
 		break;
 	case 0x99: case 0xb9:
 	case 0xd9: case 0xf9:
 		/* [word,R] */
 
-		ea = read16 (*rptr_xyus[r] + pc_read16 ());
+		ea = read16 (c, *rptr_xyus (c, r) + pc_read16 (c));
 		*cycles += 7;
 		break;
 	case 0x8b: case 0xab:
 	case 0xcb: case 0xeb:
 		/* D,R */
 
-		ea = *rptr_xyus[r] + get_reg_d ();
+		ea = *rptr_xyus (c, r) + get_reg_d (c);
 		*cycles += 4;
 		break;
 	case 0x9b: case 0xbb:
 	case 0xdb: case 0xfb:
 		/* [D,R] */
 
-		ea = read16 (*rptr_xyus[r] + get_reg_d ());
+		ea = read16 (c, *rptr_xyus (c, r) + get_reg_d (c));
 		*cycles += 7;
 		break;
 	case 0x8c: case 0xac:
 	case 0xcc: case 0xec:
 		/* byte, PC */
 
-		r = sign_extend (pc_read8 ());
-		ea = reg_pc + r;
+		r = sign_extend (pc_read8 (c));
+		ea = c->reg_pc + r;
 		*cycles += 1;
 		break;
 	case 0x9c: case 0xbc:
 	case 0xdc: case 0xfc:
 		/* [byte, PC] */
 
-		r = sign_extend (pc_read8 ());
-		ea = read16 (reg_pc + r);
+		r = sign_extend (pc_read8 (c));
+		ea = read16 (c, c->reg_pc + r);
 		*cycles += 4;
 		break;
 	case 0x8d: case 0xad:
 	case 0xcd: case 0xed:
 		/* word, PC */
 
-		r = pc_read16 ();
-		ea = reg_pc + r;
+		r = pc_read16 (c);
+		ea = c->reg_pc + r;
 		*cycles += 5;
 		break;
 	case 0x9d: case 0xbd:
 	case 0xdd: case 0xfd:
 		/* [word, PC] */
 
-		r = pc_read16 ();
-		ea = read16 (reg_pc + r);
+		r = pc_read16 (c);
+		ea = read16 (c, c->reg_pc + r);
 		*cycles += 8;
 		break;
 	case 0x9f:
 		/* [address] */
 
-		ea = read16 (pc_read16 ());
+		ea = read16 (c, pc_read16 (c));
 		*cycles += 5;
 		break;
 	default:
 		printf ("undefined post-byte\n");
+		ea = 0;
 		break;
 	}
 
@@ -512,7 +695,7 @@ static einline unsigned ea_indexed (unsigned *cycles)
  * essentially (0 - data).
  */
 
-einline unsigned inst_neg (unsigned data)
+static einline unsigned inst_neg (e6809_t *c, unsigned data)
 {
 	unsigned i0, i1, r;
 
@@ -520,27 +703,22 @@ einline unsigned inst_neg (unsigned data)
 	i1 = ~data;
 	r = i0 + i1 + 1;
 
-	set_cc (FLAG_H, test_c (i0 << 4, i1 << 4, r << 4, 0));
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
-	set_cc (FLAG_C, test_c (i0, i1, r, 1));
+	cc_record (c, CC_SUB, CC_ARITH, i0, i1, r);
 
 	return r;
 }
 
 /* instruction: com */
 
-einline unsigned inst_com (unsigned data)
+static einline unsigned inst_com (e6809_t *c, unsigned data)
 {
 	unsigned r;
 
 	r = ~data;
 	
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, 0);
-	set_cc (FLAG_C, 1);
+	set_cc (c, FLAG_V, 0);
+	set_cc (c, FLAG_C, 1);
+	cc_record (c, 0, FLAG_N | FLAG_Z, 0, 0, r);
 
 	return r;
 }
@@ -549,15 +727,15 @@ einline unsigned inst_com (unsigned data)
  * cannot be faked as an add or substract.
  */
 
-einline unsigned inst_lsr (unsigned data)
+static einline unsigned inst_lsr (e6809_t *c, unsigned data)
 {
 	unsigned r;
 
 	r = (data >> 1) & 0x7f;
 	
-	set_cc (FLAG_N, 0);
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_C, data & 1);
+	set_cc (c, FLAG_N, 0);
+	set_cc (c, FLAG_C, data & 1);
+	cc_record (c, 0, FLAG_Z, 0, 0, r);
 
 	return r;
 }
@@ -566,16 +744,15 @@ einline unsigned inst_lsr (unsigned data)
  * cannot be faked as an add or substract.
  */
 
-einline unsigned inst_ror (unsigned data)
+static einline unsigned inst_ror (e6809_t *c, unsigned data)
 {
-	unsigned r, c;
+	unsigned r, carry;
 
-	c = get_cc (FLAG_C);
-	r = ((data >> 1) & 0x7f) | (c << 7);
+	carry = get_cc (c, FLAG_C);
+	r = ((data >> 1) & 0x7f) | (carry << 7);
 	
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_C, data & 1);
+	set_cc (c, FLAG_C, data & 1);
+	cc_record (c, 0, FLAG_N | FLAG_Z, 0, 0, r);
 
 	return r;
 }
@@ -584,15 +761,14 @@ einline unsigned inst_ror (unsigned data)
  * cannot be faked as an add or substract.
  */
 
-einline unsigned inst_asr (unsigned data)
+static einline unsigned inst_asr (e6809_t *c, unsigned data)
 {
 	unsigned r;
 
 	r = ((data >> 1) & 0x7f) | (data & 0x80);
 	
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_C, data & 1);
+	set_cc (c, FLAG_C, data & 1);
+	cc_record (c, 0, FLAG_N | FLAG_Z, 0, 0, r);
 
 	return r;
 }
@@ -601,7 +777,7 @@ einline unsigned inst_asr (unsigned data)
  * essentially (data + data). simple addition.
  */
 
-einline unsigned inst_asl (unsigned data)
+static einline unsigned inst_asl (e6809_t *c, unsigned data)
 {
 	unsigned i0, i1, r;
 
@@ -609,11 +785,7 @@ einline unsigned inst_asl (unsigned data)
 	i1 = data;
 	r = i0 + i1;
 	
-	set_cc (FLAG_H, test_c (i0 << 4, i1 << 4, r << 4, 0));
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
-	set_cc (FLAG_C, test_c (i0, i1, r, 0));
+	cc_record (c, 0, CC_ARITH, i0, i1, r);
 
 	return r;
 }
@@ -622,19 +794,16 @@ einline unsigned inst_asl (unsigned data)
  * essentially (data + data + carry). addition with carry.
  */
 
-einline unsigned inst_rol (unsigned data)
+static einline unsigned inst_rol (e6809_t *c, unsigned data)
 {
-	unsigned i0, i1, c, r;
+	unsigned i0, i1, carry, r;
 
 	i0 = data;
 	i1 = data;
-	c = get_cc (FLAG_C);
-	r = i0 + i1 + c;
+	carry = get_cc (c, FLAG_C);
+	r = i0 + i1 + carry;
 	
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
-	set_cc (FLAG_C, test_c (i0, i1, r, 0));
+	cc_record (c, 0, FLAG_N | FLAG_Z | FLAG_V | FLAG_C, i0, i1, r);
 
 	return r;
 }
@@ -643,7 +812,7 @@ einline unsigned inst_rol (unsigned data)
  * essentially (data - 1).
  */
 
-einline unsigned inst_dec (unsigned data)
+static einline unsigned inst_dec (e6809_t *c, unsigned data)
 {
 	unsigned i0, i1, r;
 
@@ -651,9 +820,7 @@ einline unsigned inst_dec (unsigned data)
 	i1 = 0xff;
 	r = i0 + i1;
 	
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
+	cc_record (c, 0, FLAG_N | FLAG_Z | FLAG_V, i0, i1, r);
 
 	return r;
 }
@@ -662,7 +829,7 @@ einline unsigned inst_dec (unsigned data)
  * essentially (data + 1).
  */
 
-einline unsigned inst_inc (unsigned data)
+static einline unsigned inst_inc (e6809_t *c, unsigned data)
 {
 	unsigned i0, i1, r;
 
@@ -670,42 +837,38 @@ einline unsigned inst_inc (unsigned data)
 	i1 = 1;
 	r = i0 + i1;
 	
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
+	cc_record (c, 0, FLAG_N | FLAG_Z | FLAG_V, i0, i1, r);
 
 	return r;
 }
 
 /* instruction: tst */
 
-einline void inst_tst8 (unsigned data)
+static einline void inst_tst8 (e6809_t *c, unsigned data)
 {
-	set_cc (FLAG_N, test_n (data));
-	set_cc (FLAG_Z, test_z8 (data));
-	set_cc (FLAG_V, 0);
+	set_cc (c, FLAG_V, 0);
+	cc_record (c, 0, FLAG_N | FLAG_Z, 0, 0, data);
 }
 
-einline void inst_tst16 (unsigned data)
+static einline void inst_tst16 (e6809_t *c, unsigned data)
 {
-	set_cc (FLAG_N, test_n (data >> 8));
-	set_cc (FLAG_Z, test_z16 (data));
-	set_cc (FLAG_V, 0);
+	set_cc (c, FLAG_V, 0);
+	cc_record (c, CC_16, FLAG_N | FLAG_Z, 0, 0, data);
 }
 
 /* instruction: clr */
 
-einline void inst_clr (void)
+static einline void inst_clr (e6809_t *c)
 {
-	set_cc (FLAG_N, 0);
-	set_cc (FLAG_Z, 1);
-	set_cc (FLAG_V, 0);
-	set_cc (FLAG_C, 0);
+	set_cc (c, FLAG_N, 0);
+	set_cc (c, FLAG_Z, 1);
+	set_cc (c, FLAG_V, 0);
+	set_cc (c, FLAG_C, 0);
 }
 
 /* instruction: suba/subb */
 
-einline unsigned inst_sub8 (unsigned data0, unsigned data1)
+static einline unsigned inst_sub8 (e6809_t *c, unsigned data0, unsigned data1)
 {
 	unsigned i0, i1, r;
 
@@ -713,11 +876,7 @@ einline unsigned inst_sub8 (unsigned data0, unsigned data1)
 	i1 = ~data1;
 	r = i0 + i1 + 1;
 	
-	set_cc (FLAG_H, test_c (i0 << 4, i1 << 4, r << 4, 0));
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
-	set_cc (FLAG_C, test_c (i0, i1, r, 1));
+	cc_record (c, CC_SUB, CC_ARITH, i0, i1, r);
 
 	return r;
 }
@@ -726,20 +885,16 @@ einline unsigned inst_sub8 (unsigned data0, unsigned data1)
  * only 8-bit version, 16-bit version not needed.
  */
 
-einline unsigned inst_sbc (unsigned data0, unsigned data1)
+static einline unsigned inst_sbc (e6809_t *c, unsigned data0, unsigned data1)
 {
-	unsigned i0, i1, c, r;
+	unsigned i0, i1, carry, r;
 
 	i0 = data0;
 	i1 = ~data1;
-	c = 1 - get_cc (FLAG_C);
-	r = i0 + i1 + c;
+	carry = 1 - get_cc (c, FLAG_C);
+	r = i0 + i1 + carry;
 
-	set_cc (FLAG_H, test_c (i0 << 4, i1 << 4, r << 4, 0));
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
-	set_cc (FLAG_C, test_c (i0, i1, r, 1));
+	cc_record (c, CC_SUB, CC_ARITH, i0, i1, r);
 
 	return r;
 }
@@ -748,13 +903,13 @@ einline unsigned inst_sbc (unsigned data0, unsigned data1)
  * only 8-bit version, 16-bit version not needed.
  */
 
-einline unsigned inst_and (unsigned data0, unsigned data1)
+static einline unsigned inst_and (e6809_t *c, unsigned data0, unsigned data1)
 {
 	unsigned r;
 
 	r = data0 & data1;
 
-	inst_tst8 (r);
+	inst_tst8 (c, r);
 
 	return r;
 }
@@ -763,13 +918,13 @@ einline unsigned inst_and (unsigned data0, unsigned data1)
  * only 8-bit version, 16-bit version not needed.
  */
 
-einline unsigned inst_eor (unsigned data0, unsigned data1)
+static einline unsigned inst_eor (e6809_t *c, unsigned data0, unsigned data1)
 {
 	unsigned r;
 
 	r = data0 ^ data1;
 
-	inst_tst8 (r);
+	inst_tst8 (c, r);
 
 	return r;
 }
@@ -778,20 +933,16 @@ einline unsigned inst_eor (unsigned data0, unsigned data1)
  * only 8-bit version, 16-bit version not needed.
  */
 
-einline unsigned inst_adc (unsigned data0, unsigned data1)
+static einline unsigned inst_adc (e6809_t *c, unsigned data0, unsigned data1)
 {
-	unsigned i0, i1, c, r;
+	unsigned i0, i1, carry, r;
 
 	i0 = data0;
 	i1 = data1;
-	c = get_cc (FLAG_C);
-	r = i0 + i1 + c;
+	carry = get_cc (c, FLAG_C);
+	r = i0 + i1 + carry;
 
-	set_cc (FLAG_H, test_c (i0 << 4, i1 << 4, r << 4, 0));
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
-	set_cc (FLAG_C, test_c (i0, i1, r, 0));
+	cc_record (c, 0, CC_ARITH, i0, i1, r);
 
 	return r;
 }
@@ -800,20 +951,20 @@ einline unsigned inst_adc (unsigned data0, unsigned data1)
  * only 8-bit version, 16-bit version not needed.
  */
 
-einline unsigned inst_or (unsigned data0, unsigned data1)
+static einline unsigned inst_or (e6809_t *c, unsigned data0, unsigned data1)
 {
 	unsigned r;
 
 	r = data0 | data1;
 
-	inst_tst8 (r);
+	inst_tst8 (c, r);
 
 	return r;
 }
 
 /* instruction: adda/addb */
 
-einline unsigned inst_add8 (unsigned data0, unsigned data1)
+static einline unsigned inst_add8 (e6809_t *c, unsigned data0, unsigned data1)
 {
 	unsigned i0, i1, r;
 
@@ -821,18 +972,14 @@ einline unsigned inst_add8 (unsigned data0, unsigned data1)
 	i1 = data1;
 	r = i0 + i1;
 
-	set_cc (FLAG_H, test_c (i0 << 4, i1 << 4, r << 4, 0));
-	set_cc (FLAG_N, test_n (r));
-	set_cc (FLAG_Z, test_z8 (r));
-	set_cc (FLAG_V, test_v (i0, i1, r));
-	set_cc (FLAG_C, test_c (i0, i1, r, 0));
+	cc_record (c, 0, CC_ARITH, i0, i1, r);
 
 	return r;
 }
 
 /* instruction: addd */
 
-einline unsigned inst_add16 (unsigned data0, unsigned data1)
+static einline unsigned inst_add16 (e6809_t *c, unsigned data0, unsigned data1)
 {
 	unsigned i0, i1, r;
 
@@ -840,17 +987,14 @@ einline unsigned inst_add16 (unsigned data0, unsigned data1)
 	i1 = data1;
 	r = i0 + i1;
 
-	set_cc (FLAG_N, test_n (r >> 8));
-	set_cc (FLAG_Z, test_z16 (r));
-	set_cc (FLAG_V, test_v (i0 >> 8, i1 >> 8, r >> 8));
-	set_cc (FLAG_C, test_c (i0 >> 8, i1 >> 8, r >> 8, 0));
+	cc_record (c, CC_16, FLAG_N | FLAG_Z | FLAG_V | FLAG_C, i0, i1, r);
 
 	return r;
 }
 
 /* instruction: subd */
 
-einline unsigned inst_sub16 (unsigned data0, unsigned data1)
+static einline unsigned inst_sub16 (e6809_t *c, unsigned data0, unsigned data1)
 {
 	unsigned i0, i1, r;
 
@@ -858,174 +1002,171 @@ einline unsigned inst_sub16 (unsigned data0, unsigned data1)
 	i1 = ~data1;
 	r = i0 + i1 + 1;
 
-	set_cc (FLAG_N, test_n (r >> 8));
-	set_cc (FLAG_Z, test_z16 (r));
-	set_cc (FLAG_V, test_v (i0 >> 8, i1 >> 8, r >> 8));
-	set_cc (FLAG_C, test_c (i0 >> 8, i1 >> 8, r >> 8, 1));
+	cc_record (c, CC_16 | CC_SUB, FLAG_N | FLAG_Z | FLAG_V | FLAG_C, i0, i1, r);
 
 	return r;
 }
 
 /* instruction: 8-bit offset branch */
 
-einline void inst_bra8 (unsigned test, unsigned op, unsigned *cycles)
+static einline void inst_bra8 (e6809_t *c, unsigned test, unsigned op, unsigned *cycles)
 {
 	unsigned offset, mask;
 
-	offset = pc_read8 ();
+	offset = pc_read8 (c);
 
 	/* trying to avoid an if statement */
 
 	mask = (test ^ (op & 1)) - 1; /* 0xffff when taken, 0 when not taken */
-	reg_pc += sign_extend (offset) & mask;
+	c->reg_pc += sign_extend (offset) & mask;
 
 	*cycles += 3;
 }
 
 /* instruction: 16-bit offset branch */
 
-einline void inst_bra16 (unsigned test, unsigned op, unsigned *cycles)
+static einline void inst_bra16 (e6809_t *c, unsigned test, unsigned op, unsigned *cycles)
 {
 	unsigned offset, mask;
 
-	offset = pc_read16 ();
+	offset = pc_read16 (c);
 
 	/* trying to avoid an if statement */
 
 	mask = (test ^ (op & 1)) - 1; /* 0xffff when taken, 0 when not taken */
-	reg_pc += offset & mask;
+	c->reg_pc += offset & mask;
 
 	*cycles += 5 - mask;
 }
 
 /* instruction: pshs/pshu */
 
-einline void inst_psh (unsigned op, unsigned *sp,
+static einline void inst_psh (e6809_t *c, unsigned op, unsigned *sp,
 					   unsigned data, unsigned *cycles)
 {
 	if (op & 0x80) {
-		push16 (sp, reg_pc);
+		push16 (c, sp, c->reg_pc);
 		*cycles += 2;
 	}
 
 	if (op & 0x40) {
 		/* either s or u */
-		push16 (sp, data);
+		push16 (c, sp, data);
 		*cycles += 2;
 	}
 
 	if (op & 0x20) {
-		push16 (sp, reg_y);
+		push16 (c, sp, c->reg_y);
 		*cycles += 2;
 	}
 
 	if (op & 0x10) {
-		push16 (sp, reg_x);
+		push16 (c, sp, c->reg_x);
 		*cycles += 2;
 	}
 
 	if (op & 0x08) {
-		push8 (sp, reg_dp);
+		push8 (c, sp, c->reg_dp);
 		*cycles += 1;
 	}
 
 	if (op & 0x04) {
-		push8 (sp, reg_b);
+		push8 (c, sp, c->reg_b);
 		*cycles += 1;
 	}
 
 	if (op & 0x02) {
-		push8 (sp, reg_a);
+		push8 (c, sp, c->reg_a);
 		*cycles += 1;
 	}
 
 	if (op & 0x01) {
-		push8 (sp, reg_cc);
+		push8 (c, sp, get_reg_cc (c));
 		*cycles += 1;
 	}
 }
 
 /* instruction: puls/pulu */
 
-einline void inst_pul (unsigned op, unsigned *sp, unsigned *osp,
+static einline void inst_pul (e6809_t *c, unsigned op, unsigned *sp, unsigned *osp,
 					   unsigned *cycles)
 {
 	if (op & 0x01) {
-		reg_cc = pull8 (sp);
+		set_reg_cc (c, pull8 (c, sp));
 		*cycles += 1;
 	}
 
 	if (op & 0x02) {
-		reg_a = pull8 (sp);
+		c->reg_a = pull8 (c, sp);
 		*cycles += 1;
 	}
 
 	if (op & 0x04) {
-		reg_b = pull8 (sp);
+		c->reg_b = pull8 (c, sp);
 		*cycles += 1;
 	}
 
 	if (op & 0x08) {
-		reg_dp = pull8 (sp);
+		c->reg_dp = pull8 (c, sp);
 		*cycles += 1;
 	}
 
 	if (op & 0x10) {
-		reg_x = pull16 (sp);
+		c->reg_x = pull16 (c, sp);
 		*cycles += 2;
 	}
 
 	if (op & 0x20) {
-		reg_y = pull16 (sp);
+		c->reg_y = pull16 (c, sp);
 		*cycles += 2;
 	}
 
 	if (op & 0x40) {
 		/* either s or u */
-		*osp = pull16 (sp);
+		*osp = pull16 (c, sp);
 		*cycles += 2;
 	}
 
 	if (op & 0x80) {
-		reg_pc = pull16 (sp);
+		c->reg_pc = pull16 (c, sp);
 		*cycles += 2;
 	}
 }
 
-einline unsigned exgtfr_read (unsigned reg)
+static einline unsigned exgtfr_read (e6809_t *c, unsigned reg)
 {
 	unsigned data;
 
 	switch (reg) {
 	case 0x0:
-		data = get_reg_d ();
+		data = get_reg_d (c);
 		break;
 	case 0x1:
-		data = reg_x;
+		data = c->reg_x;
 		break;
 	case 0x2:
-		data = reg_y;
+		data = c->reg_y;
 		break;
 	case 0x3:
-		data = reg_u;
+		data = c->reg_u;
 		break;
 	case 0x4:
-		data = reg_s;
+		data = c->reg_s;
 		break;
 	case 0x5:
-		data = reg_pc;
+		data = c->reg_pc;
 		break;
 	case 0x8:
-		data = 0xff00 | reg_a;
+		data = 0xff00 | c->reg_a;
 		break;
 	case 0x9:
-		data = 0xff00 | reg_b;
+		data = 0xff00 | c->reg_b;
 		break;
 	case 0xa:
-		data = 0xff00 | reg_cc;
+		data = 0xff00 | get_reg_cc (c);
 		break;
 	case 0xb:
-		data = 0xff00 | reg_dp;
+		data = 0xff00 | c->reg_dp;
 		break;
 	default:
 		data = 0xffff;
@@ -1036,38 +1177,38 @@ einline unsigned exgtfr_read (unsigned reg)
 	return data;
 }
 
-einline void exgtfr_write (unsigned reg, unsigned data)
+static einline void exgtfr_write (e6809_t *c, unsigned reg, unsigned data)
 {
 	switch (reg) {
 	case 0x0:
-		set_reg_d (data);
+		set_reg_d (c, data);
 		break;
 	case 0x1:
-		reg_x = data;
+		c->reg_x = data;
 		break;
 	case 0x2:
-		reg_y = data;
+		c->reg_y = data;
 		break;
 	case 0x3:
-		reg_u = data;
+		c->reg_u = data;
 		break;
 	case 0x4:
-		reg_s = data;
+		c->reg_s = data;
 		break;
 	case 0x5:
-		reg_pc = data;
+		c->reg_pc = data;
 		break;
 	case 0x8:
-		reg_a = data;
+		c->reg_a = data;
 		break;
 	case 0x9:
-		reg_b = data;
+		c->reg_b = data;
 		break;
 	case 0xa:
-		reg_cc = data;
+		set_reg_cc (c, data);
 		break;
 	case 0xb:
-		reg_dp = data;
+		c->reg_dp = data;
 		break;
 	default:
 		printf ("illegal exgtfr reg %.1x\n", reg);
@@ -1077,1547 +1218,3614 @@ einline void exgtfr_write (unsigned reg, unsigned data)
 
 /* instruction: exg */
 
-einline void inst_exg (void)
+static einline void inst_exg (e6809_t *c)
 {
 	unsigned op, tmp;
 
-	op = pc_read8 ();
+	op = pc_read8 (c);
 
-	tmp = exgtfr_read (op & 0xf);
-	exgtfr_write (op & 0xf, exgtfr_read (op >> 4));
-	exgtfr_write (op >> 4, tmp);
+	tmp = exgtfr_read (c, op & 0xf);
+	exgtfr_write (c, op & 0xf, exgtfr_read (c, op >> 4));
+	exgtfr_write (c, op >> 4, tmp);
 }
 
 /* instruction: tfr */
 
-einline void inst_tfr (void)
+static einline void inst_tfr (e6809_t *c)
 {
 	unsigned op;
 
-	op = pc_read8 ();
+	op = pc_read8 (c);
 
-	exgtfr_write (op & 0xf, exgtfr_read (op >> 4));
+	exgtfr_write (c, op & 0xf, exgtfr_read (c, op >> 4));
 }
 
 /* reset the 6809 */
 
-void e6809_reset (void)
+/* opcodes not recognised by the 6809 */
+
+static einline void op_unknown0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	printf ("unknown page-0 op code: %.2x\n", op);
+}
+
+static einline void op_unknown1 (e6809_t *c, unsigned op, unsigned *cycles)
 {
-	reg_x = 0;
-	reg_y = 0;
-	reg_u = 0;
-	reg_s = 0;
+	printf ("unknown page-1 op code: %.2x\n", op);
+}
+
+static einline void op_unknown2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	printf ("unknown page-2 op code: %.2x\n", op);
+}
+
+/* base cycle counts for each opcode, excluding the extra cycles of indexed
+ * addressing, taken long branches and register stacking which the
+ * handlers add themselves. prefixed opcodes include the prefix byte.
+ */
+
+static const unsigned char cycles_page0[256] = {
+	 6,  0,  0,  6,  6,  0,  6,  6,  6,  6,  6,  0,  6,  6,  3,  6,	/* 00 */
+	 0,  0,  2,  2,  0,  0,  5,  9,  0,  2,  3,  0,  3,  2,  8,  6,	/* 10 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 20 */
+	 4,  4,  4,  4,  5,  5,  5,  5,  0,  5,  3,  3,  4, 11,  0,  7,	/* 30 */
+	 2,  0,  0,  2,  2,  0,  2,  2,  2,  2,  2,  0,  2,  2,  0,  2,	/* 40 */
+	 2,  0,  0,  2,  2,  0,  2,  2,  2,  2,  2,  0,  2,  2,  0,  2,	/* 50 */
+	 6,  0,  0,  6,  6,  0,  6,  6,  6,  6,  6,  0,  6,  6,  3,  6,	/* 60 */
+	 7,  0,  0,  7,  7,  0,  7,  7,  7,  7,  7,  0,  7,  7,  4,  7,	/* 70 */
+	 2,  2,  2,  4,  2,  2,  2,  0,  2,  2,  2,  2,  4,  7,  3,  0,	/* 80 */
+	 4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  6,  7,  5,  5,	/* 90 */
+	 4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  6,  7,  5,  5,	/* a0 */
+	 5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  5,  7,  8,  6,  6,	/* b0 */
+	 2,  2,  2,  4,  2,  2,  2,  0,  2,  2,  2,  2,  3,  0,  3,  0,	/* c0 */
+	 4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  5,  5,  5,  5,	/* d0 */
+	 4,  4,  4,  6,  4,  4,  4,  4,  4,  4,  4,  4,  5,  5,  5,  5,	/* e0 */
+	 5,  5,  5,  7,  5,  5,  5,  5,  5,  5,  5,  5,  6,  6,  6,  6	/* f0 */
+};
 
-	reg_a = 0;
-	reg_b = 0;
+static const unsigned char cycles_page1[256] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 00 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 10 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 20 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  8,	/* 30 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 40 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 50 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 60 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 70 */
+	 0,  0,  0,  5,  0,  0,  0,  0,  0,  0,  0,  0,  5,  0,  4,  0,	/* 80 */
+	 0,  0,  0,  7,  0,  0,  0,  0,  0,  0,  0,  0,  7,  0,  6,  6,	/* 90 */
+	 0,  0,  0,  7,  0,  0,  0,  0,  0,  0,  0,  0,  7,  0,  6,  6,	/* a0 */
+	 0,  0,  0,  8,  0,  0,  0,  0,  0,  0,  0,  0,  8,  0,  7,  7,	/* b0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  4,  0,	/* c0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  6,  6,	/* d0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  6,  6,	/* e0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  7,  7	/* f0 */
+};
+
+static const unsigned char cycles_page2[256] = {
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 00 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 10 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 20 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  8,	/* 30 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 40 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 50 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 60 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* 70 */
+	 0,  0,  0,  5,  0,  0,  0,  0,  0,  0,  0,  0,  5,  0,  0,  0,	/* 80 */
+	 0,  0,  0,  7,  0,  0,  0,  0,  0,  0,  0,  0,  7,  0,  0,  0,	/* 90 */
+	 0,  0,  0,  7,  0,  0,  0,  0,  0,  0,  0,  0,  7,  0,  0,  0,	/* a0 */
+	 0,  0,  0,  8,  0,  0,  0,  0,  0,  0,  0,  0,  8,  0,  0,  0,	/* b0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* c0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* d0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,	/* e0 */
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0	/* f0 */
+};
+
+/* page 0 instructions */
 
-	reg_dp = 0;
+/* neg, nega, negb */
 
-	reg_cc = FLAG_I | FLAG_F;
-	irq_status = IRQ_NORMAL;
+static einline void op_00 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
 
-	reg_pc = read16 (0xfffe);
+	ea = ea_direct (c);
+	r = inst_neg (c, read8 (c, ea));
+	write8 (c, ea, r);
 }
 
-/* execute a single instruction or handle interrupts and return */
+static einline void op_40 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_neg (c, c->reg_a);
+}
 
-unsigned e6809_sstep (unsigned irq_i, unsigned irq_f)
+static einline void op_50 (e6809_t *c, unsigned op, unsigned *cycles)
 {
-	unsigned op;
-	unsigned cycles = 0;
-	unsigned ea, i0, i1, r;
+	c->reg_b = inst_neg (c, c->reg_b);
+}
 
-	if (irq_f) {
-		if (get_cc (FLAG_F) == 0) {
-			if (irq_status != IRQ_CWAI) {
-				set_cc (FLAG_E, 0);
-				inst_psh (0x81, &reg_s, reg_u, &cycles);
-			}
+static einline void op_60 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
 
-			set_cc (FLAG_I, 1);
-			set_cc (FLAG_F, 1);
+	ea = ea_indexed (c, cycles);
+	r = inst_neg (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
 
-			reg_pc = read16 (0xfff6);
-			irq_status = IRQ_NORMAL;
-			cycles += 7;
-		} else {
-			if (irq_status == IRQ_SYNC) {
-				irq_status = IRQ_NORMAL;
-			}
-		}
-	}
-	
-	if (irq_i) {
-		if (get_cc (FLAG_I) == 0) {
-			if (irq_status != IRQ_CWAI) {
-				set_cc (FLAG_E, 1);
-				inst_psh (0xff, &reg_s, reg_u, &cycles);
-			}
+static einline void op_70 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
 
-			set_cc (FLAG_I, 1);
+	ea = ea_extended (c);
+	r = inst_neg (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
 
-			reg_pc = read16 (0xfff8);
-			irq_status = IRQ_NORMAL;
-			cycles += 7;
-		} else {
-			if (irq_status == IRQ_SYNC) {
-				irq_status = IRQ_NORMAL;
-			}
-		}
-	}
+/* com, coma, comb */
 
-	if (irq_status != IRQ_NORMAL) {
-		return cycles + 1;
-	}
+static einline void op_03 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
 
-	op = pc_read8 ();
+	ea = ea_direct (c);
+	r = inst_com (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_43 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_com (c, c->reg_a);
+}
+
+static einline void op_53 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_com (c, c->reg_b);
+}
+
+static einline void op_63 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_com (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_73 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_com (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* lsr, lsra, lsrb */
+
+static einline void op_04 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_direct (c);
+	r = inst_lsr (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_44 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_lsr (c, c->reg_a);
+}
+
+static einline void op_54 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_lsr (c, c->reg_b);
+}
+
+static einline void op_64 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_lsr (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_74 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_lsr (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* ror, rora, rorb */
+
+static einline void op_06 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_direct (c);
+	r = inst_ror (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_46 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_ror (c, c->reg_a);
+}
+
+static einline void op_56 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_ror (c, c->reg_b);
+}
+
+static einline void op_66 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_ror (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_76 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_ror (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* asr, asra, asrb */
+
+static einline void op_07 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_direct (c);
+	r = inst_asr (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_47 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_asr (c, c->reg_a);
+}
+
+static einline void op_57 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_asr (c, c->reg_b);
+}
+
+static einline void op_67 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_asr (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_77 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_asr (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* asl, asla, aslb */
+
+static einline void op_08 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_direct (c);
+	r = inst_asl (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_48 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_asl (c, c->reg_a);
+}
+
+static einline void op_58 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_asl (c, c->reg_b);
+}
+
+static einline void op_68 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_asl (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_78 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_asl (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* rol, rola, rolb */
+
+static einline void op_09 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_direct (c);
+	r = inst_rol (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_49 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_rol (c, c->reg_a);
+}
+
+static einline void op_59 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_rol (c, c->reg_b);
+}
+
+static einline void op_69 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_rol (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_79 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_rol (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* dec, deca, decb */
+
+static einline void op_0a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_direct (c);
+	r = inst_dec (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_4a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_dec (c, c->reg_a);
+}
+
+static einline void op_5a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_dec (c, c->reg_b);
+}
+
+static einline void op_6a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_dec (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_7a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_dec (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* inc, inca, incb */
+
+static einline void op_0c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_direct (c);
+	r = inst_inc (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_4c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_inc (c, c->reg_a);
+}
+
+static einline void op_5c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_inc (c, c->reg_b);
+}
+
+static einline void op_6c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_indexed (c, cycles);
+	r = inst_inc (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+static einline void op_7c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea, r;
+
+	ea = ea_extended (c);
+	r = inst_inc (c, read8 (c, ea));
+	write8 (c, ea, r);
+}
+
+/* tst, tsta, tstb */
+
+static einline void op_0d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_tst8 (c, read8 (c, ea));
+}
+
+static einline void op_4d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_tst8 (c, c->reg_a);
+}
+
+static einline void op_5d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_tst8 (c, c->reg_b);
+}
+
+static einline void op_6d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_tst8 (c, read8 (c, ea));
+}
+
+static einline void op_7d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_tst8 (c, read8 (c, ea));
+}
+
+/* jmp */
+
+static einline void op_0e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_pc = ea_direct (c);
+}
+
+static einline void op_6e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_pc = ea_indexed (c, cycles);
+}
+
+static einline void op_7e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_pc = ea_extended (c);
+}
+
+/* clr */
+
+static einline void op_0f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_clr (c);
+	write8 (c, ea, 0);
+}
+
+static einline void op_4f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_clr (c);
+	c->reg_a = 0;
+}
+
+static einline void op_5f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_clr (c);
+	c->reg_b = 0;
+}
+
+static einline void op_6f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_clr (c);
+	write8 (c, ea, 0);
+}
+
+static einline void op_7f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_clr (c);
+	write8 (c, ea, 0);
+}
+
+/* suba */
+
+static einline void op_80 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_sub8 (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_90 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = inst_sub8 (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_a0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = inst_sub8 (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_b0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = inst_sub8 (c, c->reg_a, read8 (c, ea));
+}
+
+/* subb */
+
+static einline void op_c0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_sub8 (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_d0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = inst_sub8 (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_e0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = inst_sub8 (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_f0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = inst_sub8 (c, c->reg_b, read8 (c, ea));
+}
+
+/* cmpa */
+
+static einline void op_81 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_sub8 (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_91 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_sub8 (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_a1 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_sub8 (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_b1 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_sub8 (c, c->reg_a, read8 (c, ea));
+}
+
+/* cmpb */
+
+static einline void op_c1 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_sub8 (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_d1 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_sub8 (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_e1 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_sub8 (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_f1 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_sub8 (c, c->reg_b, read8 (c, ea));
+}
+
+/* sbca */
+
+static einline void op_82 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_sbc (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_92 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = inst_sbc (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_a2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = inst_sbc (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_b2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = inst_sbc (c, c->reg_a, read8 (c, ea));
+}
+
+/* sbcb */
+
+static einline void op_c2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_sbc (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_d2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = inst_sbc (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_e2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = inst_sbc (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_f2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = inst_sbc (c, c->reg_b, read8 (c, ea));
+}
+
+/* anda */
+
+static einline void op_84 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_and (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_94 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = inst_and (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_a4 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = inst_and (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_b4 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = inst_and (c, c->reg_a, read8 (c, ea));
+}
+
+/* andb */
+
+static einline void op_c4 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_and (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_d4 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = inst_and (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_e4 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = inst_and (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_f4 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = inst_and (c, c->reg_b, read8 (c, ea));
+}
+
+/* bita */
+
+static einline void op_85 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_and (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_95 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_and (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_a5 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_and (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_b5 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_and (c, c->reg_a, read8 (c, ea));
+}
+
+/* bitb */
+
+static einline void op_c5 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_and (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_d5 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_and (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_e5 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_and (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_f5 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_and (c, c->reg_b, read8 (c, ea));
+}
+
+/* lda */
+
+static einline void op_86 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = pc_read8 (c);
+	inst_tst8 (c, c->reg_a);
+}
+
+static einline void op_96 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = read8 (c, ea);
+	inst_tst8 (c, c->reg_a);
+}
+
+static einline void op_a6 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = read8 (c, ea);
+	inst_tst8 (c, c->reg_a);
+}
+
+static einline void op_b6 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = read8 (c, ea);
+	inst_tst8 (c, c->reg_a);
+}
+
+/* ldb */
+
+static einline void op_c6 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = pc_read8 (c);
+	inst_tst8 (c, c->reg_b);
+}
+
+static einline void op_d6 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = read8 (c, ea);
+	inst_tst8 (c, c->reg_b);
+}
+
+static einline void op_e6 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = read8 (c, ea);
+	inst_tst8 (c, c->reg_b);
+}
+
+static einline void op_f6 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = read8 (c, ea);
+	inst_tst8 (c, c->reg_b);
+}
+
+/* sta */
+
+static einline void op_97 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	write8 (c, ea, c->reg_a);
+	inst_tst8 (c, c->reg_a);
+}
+
+static einline void op_a7 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	write8 (c, ea, c->reg_a);
+	inst_tst8 (c, c->reg_a);
+}
+
+static einline void op_b7 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	write8 (c, ea, c->reg_a);
+	inst_tst8 (c, c->reg_a);
+}
+
+/* stb */
+
+static einline void op_d7 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	write8 (c, ea, c->reg_b);
+	inst_tst8 (c, c->reg_b);
+}
+
+static einline void op_e7 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	write8 (c, ea, c->reg_b);
+	inst_tst8 (c, c->reg_b);
+}
+
+static einline void op_f7 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	write8 (c, ea, c->reg_b);
+	inst_tst8 (c, c->reg_b);
+}
+
+/* eora */
+
+static einline void op_88 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_eor (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_98 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = inst_eor (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_a8 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = inst_eor (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_b8 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = inst_eor (c, c->reg_a, read8 (c, ea));
+}
+
+/* eorb */
+
+static einline void op_c8 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_eor (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_d8 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = inst_eor (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_e8 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = inst_eor (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_f8 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = inst_eor (c, c->reg_b, read8 (c, ea));
+}
+
+/* adca */
+
+static einline void op_89 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_adc (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_99 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = inst_adc (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_a9 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = inst_adc (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_b9 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = inst_adc (c, c->reg_a, read8 (c, ea));
+}
+
+/* adcb */
+
+static einline void op_c9 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_adc (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_d9 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = inst_adc (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_e9 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = inst_adc (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_f9 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = inst_adc (c, c->reg_b, read8 (c, ea));
+}
+
+/* ora */
+
+static einline void op_8a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_or (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_9a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = inst_or (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_aa (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = inst_or (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_ba (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = inst_or (c, c->reg_a, read8 (c, ea));
+}
+
+/* orb */
+
+static einline void op_ca (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_or (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_da (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = inst_or (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_ea (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = inst_or (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_fa (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = inst_or (c, c->reg_b, read8 (c, ea));
+}
+
+/* adda */
+
+static einline void op_8b (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_a = inst_add8 (c, c->reg_a, pc_read8 (c));
+}
+
+static einline void op_9b (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_a = inst_add8 (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_ab (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_a = inst_add8 (c, c->reg_a, read8 (c, ea));
+}
+
+static einline void op_bb (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_a = inst_add8 (c, c->reg_a, read8 (c, ea));
+}
+
+/* addb */
+
+static einline void op_cb (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_b = inst_add8 (c, c->reg_b, pc_read8 (c));
+}
+
+static einline void op_db (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_b = inst_add8 (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_eb (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_b = inst_add8 (c, c->reg_b, read8 (c, ea));
+}
+
+static einline void op_fb (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_b = inst_add8 (c, c->reg_b, read8 (c, ea));
+}
+
+/* subd */
+
+static einline void op_83 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_reg_d (c, inst_sub16 (c, get_reg_d (c), pc_read16 (c)));
+}
+
+static einline void op_93 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	set_reg_d (c, inst_sub16 (c, get_reg_d (c), read16 (c, ea)));
+}
+
+static einline void op_a3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	set_reg_d (c, inst_sub16 (c, get_reg_d (c), read16 (c, ea)));
+}
+
+static einline void op_b3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	set_reg_d (c, inst_sub16 (c, get_reg_d (c), read16 (c, ea)));
+}
+
+/* cmpx */
+
+static einline void op_8c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_sub16 (c, c->reg_x, pc_read16 (c));
+}
+
+static einline void op_9c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_sub16 (c, c->reg_x, read16 (c, ea));
+}
+
+static einline void op_ac (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_sub16 (c, c->reg_x, read16 (c, ea));
+}
+
+static einline void op_bc (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_sub16 (c, c->reg_x, read16 (c, ea));
+}
+
+/* ldx */
+
+static einline void op_8e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_x = pc_read16 (c);
+	inst_tst16 (c, c->reg_x);
+}
+
+static einline void op_9e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_x = read16 (c, ea);
+	inst_tst16 (c, c->reg_x);
+}
+
+static einline void op_ae (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_x = read16 (c, ea);
+	inst_tst16 (c, c->reg_x);
+}
+
+static einline void op_be (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_x = read16 (c, ea);
+	inst_tst16 (c, c->reg_x);
+}
+
+/* ldu */
+
+static einline void op_ce (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_u = pc_read16 (c);
+	inst_tst16 (c, c->reg_u);
+}
+
+static einline void op_de (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_u = read16 (c, ea);
+	inst_tst16 (c, c->reg_u);
+}
+
+static einline void op_ee (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_u = read16 (c, ea);
+	inst_tst16 (c, c->reg_u);
+}
+
+static einline void op_fe (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_u = read16 (c, ea);
+	inst_tst16 (c, c->reg_u);
+}
+
+/* stx */
+
+static einline void op_9f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	write16 (c, ea, c->reg_x);
+	inst_tst16 (c, c->reg_x);
+}
+
+static einline void op_af (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	write16 (c, ea, c->reg_x);
+	inst_tst16 (c, c->reg_x);
+}
+
+static einline void op_bf (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	write16 (c, ea, c->reg_x);
+	inst_tst16 (c, c->reg_x);
+}
+
+/* stu */
+
+static einline void op_df (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	write16 (c, ea, c->reg_u);
+	inst_tst16 (c, c->reg_u);
+}
+
+static einline void op_ef (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	write16 (c, ea, c->reg_u);
+	inst_tst16 (c, c->reg_u);
+}
+
+static einline void op_ff (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	write16 (c, ea, c->reg_u);
+	inst_tst16 (c, c->reg_u);
+}
+
+/* addd */
+
+static einline void op_c3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_reg_d (c, inst_add16 (c, get_reg_d (c), pc_read16 (c)));
+}
+
+static einline void op_d3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	set_reg_d (c, inst_add16 (c, get_reg_d (c), read16 (c, ea)));
+}
+
+static einline void op_e3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	set_reg_d (c, inst_add16 (c, get_reg_d (c), read16 (c, ea)));
+}
+
+static einline void op_f3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	set_reg_d (c, inst_add16 (c, get_reg_d (c), read16 (c, ea)));
+}
+
+/* ldd */
+
+static einline void op_cc (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_reg_d (c, pc_read16 (c));
+	inst_tst16 (c, get_reg_d (c));
+}
+
+static einline void op_dc (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	set_reg_d (c, read16 (c, ea));
+	inst_tst16 (c, get_reg_d (c));
+}
+
+static einline void op_ec (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	set_reg_d (c, read16 (c, ea));
+	inst_tst16 (c, get_reg_d (c));
+}
+
+static einline void op_fc (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	set_reg_d (c, read16 (c, ea));
+	inst_tst16 (c, get_reg_d (c));
+}
+
+/* std */
+
+static einline void op_dd (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	write16 (c, ea, get_reg_d (c));
+	inst_tst16 (c, get_reg_d (c));
+}
+
+static einline void op_ed (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	write16 (c, ea, get_reg_d (c));
+	inst_tst16 (c, get_reg_d (c));
+}
+
+static einline void op_fd (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	write16 (c, ea, get_reg_d (c));
+	inst_tst16 (c, get_reg_d (c));
+}
+
+/* nop */
+
+static einline void op_12 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+}
+
+/* mul */
+
+static einline void op_3d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned r;
+
+	r = (c->reg_a & 0xff) * (c->reg_b & 0xff);
+	set_reg_d (c, r);
+
+	set_cc (c, FLAG_Z, test_z16 (r));
+	set_cc (c, FLAG_C, (r >> 7) & 1);
+}
+
+/* bra, brn */
+
+static einline void op_20 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, 0, op, cycles);
+}
+
+/* bhi, bls */
+
+static einline void op_22 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, get_cc (c, FLAG_C) | get_cc (c, FLAG_Z), op, cycles);
+}
+
+/* bhs/bcc, blo/bcs */
+
+static einline void op_24 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, get_cc (c, FLAG_C), op, cycles);
+}
+
+/* bne, beq */
+
+static einline void op_26 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, get_cc (c, FLAG_Z), op, cycles);
+}
+
+/* bvc, bvs */
+
+static einline void op_28 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, get_cc (c, FLAG_V), op, cycles);
+}
+
+/* bpl, bmi */
+
+static einline void op_2a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, get_cc (c, FLAG_N), op, cycles);
+}
+
+/* bge, blt */
+
+static einline void op_2c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, get_cc (c, FLAG_N) ^ get_cc (c, FLAG_V), op, cycles);
+}
+
+/* bgt, ble */
+
+static einline void op_2e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra8 (c, get_cc (c, FLAG_Z) |
+			   (get_cc (c, FLAG_N) ^ get_cc (c, FLAG_V)), op, cycles);
+}
+
+/* lbra */
+
+static einline void op_16 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned r;
+
+	r = pc_read16 (c);
+	c->reg_pc += r;
+}
+
+/* lbsr */
+
+static einline void op_17 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned r;
+
+	r = pc_read16 (c);
+	push16 (c, &c->reg_s, c->reg_pc);
+	c->reg_pc += r;
+}
+
+/* bsr */
+
+static einline void op_8d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned r;
+
+	r = pc_read8 (c);
+	push16 (c, &c->reg_s, c->reg_pc);
+	c->reg_pc += sign_extend (r);
+}
+
+/* jsr */
+
+static einline void op_9d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	push16 (c, &c->reg_s, c->reg_pc);
+	c->reg_pc = ea;
+}
+
+static einline void op_ad (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	push16 (c, &c->reg_s, c->reg_pc);
+	c->reg_pc = ea;
+}
+
+static einline void op_bd (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	push16 (c, &c->reg_s, c->reg_pc);
+	c->reg_pc = ea;
+}
+
+/* leax */
+
+static einline void op_30 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_x = ea_indexed (c, cycles);
+	set_cc (c, FLAG_Z, test_z16 (c->reg_x));
+}
+
+/* leay */
+
+static einline void op_31 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_y = ea_indexed (c, cycles);
+	set_cc (c, FLAG_Z, test_z16 (c->reg_y));
+}
+
+/* leas */
+
+static einline void op_32 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_s = ea_indexed (c, cycles);
+}
+
+/* leau */
+
+static einline void op_33 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_u = ea_indexed (c, cycles);
+}
+
+/* pshs */
+
+static einline void op_34 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_psh (c, pc_read8 (c), &c->reg_s, c->reg_u, cycles);
+}
+
+/* puls */
+
+static einline void op_35 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_pul (c, pc_read8 (c), &c->reg_s, &c->reg_u, cycles);
+}
+
+/* pshu */
+
+static einline void op_36 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_psh (c, pc_read8 (c), &c->reg_u, c->reg_s, cycles);
+}
+
+/* pulu */
+
+static einline void op_37 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_pul (c, pc_read8 (c), &c->reg_u, &c->reg_s, cycles);
+}
+
+/* rts */
+
+static einline void op_39 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_pc = pull16 (c, &c->reg_s);
+}
+
+/* abx */
+
+static einline void op_3a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_x += c->reg_b & 0xff;
+}
+
+/* orcc */
+
+static einline void op_1a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_reg_cc (c, get_reg_cc (c) | pc_read8 (c));
+}
+
+/* andcc */
+
+static einline void op_1c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_reg_cc (c, get_reg_cc (c) & pc_read8 (c));
+}
+
+/* sex */
+
+static einline void op_1d (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_reg_d (c, sign_extend (c->reg_b));
+	set_cc (c, FLAG_N, test_n (c->reg_a));
+	set_cc (c, FLAG_Z, test_z16 (get_reg_d (c)));
+}
+
+/* exg */
+
+static einline void op_1e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_exg (c);
+}
+
+/* tfr */
+
+static einline void op_1f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_tfr (c);
+}
+
+/* rti */
+
+static einline void op_3b (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	if (get_cc (c, FLAG_E)) {
+		inst_pul (c, 0xff, &c->reg_s, &c->reg_u, cycles);
+	} else {
+		inst_pul (c, 0x81, &c->reg_s, &c->reg_u, cycles);
+	}
+}
+
+/* swi */
+
+static einline void op_3f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_cc (c, FLAG_E, 1);
+	inst_psh (c, 0xff, &c->reg_s, c->reg_u, cycles);
+	set_cc (c, FLAG_I, 1);
+	set_cc (c, FLAG_F, 1);
+	c->reg_pc = read16 (c, 0xfffa);
+}
+
+/* sync */
+
+static einline void op_13 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->irq_status = IRQ_SYNC;
+}
+
+/* daa */
+
+static einline void op_19 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned i0, i1;
+
+	i0 = c->reg_a;
+	i1 = 0;
+
+	if ((c->reg_a & 0x0f) > 0x09 || get_cc (c, FLAG_H) == 1) {
+		i1 |= 0x06;
+	}
+
+	if ((c->reg_a & 0xf0) > 0x80 && (c->reg_a & 0x0f) > 0x09) {
+		i1 |= 0x60;
+	}
+
+	if ((c->reg_a & 0xf0) > 0x90 || get_cc (c, FLAG_C) == 1) {
+		i1 |= 0x60;
+	}
+
+	c->reg_a = i0 + i1;
+
+	set_cc (c, FLAG_N, test_n (c->reg_a));
+	set_cc (c, FLAG_Z, test_z8 (c->reg_a));
+	set_cc (c, FLAG_V, 0);
+	set_cc (c, FLAG_C, test_c (i0, i1, c->reg_a, 0));
+}
+
+/* cwai */
+
+static einline void op_3c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_reg_cc (c, get_reg_cc (c) & pc_read8 (c));
+	set_cc (c, FLAG_E, 1);
+	inst_psh (c, 0xff, &c->reg_s, c->reg_u, cycles);
+	c->irq_status = IRQ_CWAI;
+}
+
+/* page 1 and 2 instructions */
+
+/* lbra, lbrn */
+
+static einline void op_10_20 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, 0, op, cycles);
+}
+
+/* lbhi, lbls */
+
+static einline void op_10_22 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, get_cc (c, FLAG_C) | get_cc (c, FLAG_Z), op, cycles);
+}
+
+/* lbhs/lbcc, lblo/lbcs */
+
+static einline void op_10_24 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, get_cc (c, FLAG_C), op, cycles);
+}
+
+/* lbne, lbeq */
+
+static einline void op_10_26 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, get_cc (c, FLAG_Z), op, cycles);
+}
+
+/* lbvc, lbvs */
+
+static einline void op_10_28 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, get_cc (c, FLAG_V), op, cycles);
+}
+
+/* lbpl, lbmi */
+
+static einline void op_10_2a (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, get_cc (c, FLAG_N), op, cycles);
+}
+
+/* lbge, lblt */
+
+static einline void op_10_2c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, get_cc (c, FLAG_N) ^ get_cc (c, FLAG_V), op, cycles);
+}
+
+/* lbgt, lble */
+
+static einline void op_10_2e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_bra16 (c, get_cc (c, FLAG_Z) |
+				(get_cc (c, FLAG_N) ^ get_cc (c, FLAG_V)), op, cycles);
+}
+
+/* cmpd */
+
+static einline void op_10_83 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_sub16 (c, get_reg_d (c), pc_read16 (c));
+}
+
+static einline void op_10_93 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_sub16 (c, get_reg_d (c), read16 (c, ea));
+}
+
+static einline void op_10_a3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_sub16 (c, get_reg_d (c), read16 (c, ea));
+}
+
+static einline void op_10_b3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_sub16 (c, get_reg_d (c), read16 (c, ea));
+}
+
+/* cmpy */
+
+static einline void op_10_8c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_sub16 (c, c->reg_y, pc_read16 (c));
+}
+
+static einline void op_10_9c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_sub16 (c, c->reg_y, read16 (c, ea));
+}
+
+static einline void op_10_ac (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_sub16 (c, c->reg_y, read16 (c, ea));
+}
+
+static einline void op_10_bc (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_sub16 (c, c->reg_y, read16 (c, ea));
+}
+
+/* ldy */
+
+static einline void op_10_8e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_y = pc_read16 (c);
+	inst_tst16 (c, c->reg_y);
+}
+
+static einline void op_10_9e (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_y = read16 (c, ea);
+	inst_tst16 (c, c->reg_y);
+}
+
+static einline void op_10_ae (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_y = read16 (c, ea);
+	inst_tst16 (c, c->reg_y);
+}
+
+static einline void op_10_be (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_y = read16 (c, ea);
+	inst_tst16 (c, c->reg_y);
+}
+
+/* sty */
+
+static einline void op_10_9f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	write16 (c, ea, c->reg_y);
+	inst_tst16 (c, c->reg_y);
+}
+
+static einline void op_10_af (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	write16 (c, ea, c->reg_y);
+	inst_tst16 (c, c->reg_y);
+}
+
+static einline void op_10_bf (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	write16 (c, ea, c->reg_y);
+	inst_tst16 (c, c->reg_y);
+}
+
+/* lds */
+
+static einline void op_10_ce (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	c->reg_s = pc_read16 (c);
+	inst_tst16 (c, c->reg_s);
+}
+
+static einline void op_10_de (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	c->reg_s = read16 (c, ea);
+	inst_tst16 (c, c->reg_s);
+}
+
+static einline void op_10_ee (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	c->reg_s = read16 (c, ea);
+	inst_tst16 (c, c->reg_s);
+}
+
+static einline void op_10_fe (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	c->reg_s = read16 (c, ea);
+	inst_tst16 (c, c->reg_s);
+}
+
+/* sts */
+
+static einline void op_10_df (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	write16 (c, ea, c->reg_s);
+	inst_tst16 (c, c->reg_s);
+}
+
+static einline void op_10_ef (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	write16 (c, ea, c->reg_s);
+	inst_tst16 (c, c->reg_s);
+}
+
+static einline void op_10_ff (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	write16 (c, ea, c->reg_s);
+	inst_tst16 (c, c->reg_s);
+}
+
+/* swi2 */
+
+static einline void op_10_3f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_cc (c, FLAG_E, 1);
+	inst_psh (c, 0xff, &c->reg_s, c->reg_u, cycles);
+	c->reg_pc = read16 (c, 0xfff4);
+}
+
+/* cmpu */
+
+static einline void op_11_83 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_sub16 (c, c->reg_u, pc_read16 (c));
+}
+
+static einline void op_11_93 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_sub16 (c, c->reg_u, read16 (c, ea));
+}
+
+static einline void op_11_a3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_sub16 (c, c->reg_u, read16 (c, ea));
+}
+
+static einline void op_11_b3 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_sub16 (c, c->reg_u, read16 (c, ea));
+}
+
+/* cmps */
+
+static einline void op_11_8c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	inst_sub16 (c, c->reg_s, pc_read16 (c));
+}
+
+static einline void op_11_9c (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_direct (c);
+	inst_sub16 (c, c->reg_s, read16 (c, ea));
+}
+
+static einline void op_11_ac (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_indexed (c, cycles);
+	inst_sub16 (c, c->reg_s, read16 (c, ea));
+}
+
+static einline void op_11_bc (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	unsigned ea;
+
+	ea = ea_extended (c);
+	inst_sub16 (c, c->reg_s, read16 (c, ea));
+}
+
+/* swi3 */
+
+static einline void op_11_3f (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	set_cc (c, FLAG_E, 1);
+	inst_psh (c, 0xff, &c->reg_s, c->reg_u, cycles);
+	c->reg_pc = read16 (c, 0xfff2);
+}
+
+/* page 1 and 2 dispatch. E6809_TABLE_DISPATCH selects indexing an array of
+ * handler pointers, otherwise a switch lets the compiler build its own jump
+ * table and inline the handlers into it. the tables are also used by the
+ * decoded instruction cache.
+ */
+
+static void (* const ops_page1[256]) (e6809_t *c, unsigned op, unsigned *cycles) = {
+	/* 00 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	/* 10 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	/* 20 */
+	op_10_20,    op_10_20,    op_10_22,    op_10_22,
+	op_10_24,    op_10_24,    op_10_26,    op_10_26,
+	op_10_28,    op_10_28,    op_10_2a,    op_10_2a,
+	op_10_2c,    op_10_2c,    op_10_2e,    op_10_2e,
+	/* 30 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_10_3f,
+	/* 40 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	/* 50 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	/* 60 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	/* 70 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	/* 80 */
+	op_unknown1, op_unknown1, op_unknown1, op_10_83,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_10_8c,    op_unknown1, op_10_8e,    op_unknown1,
+	/* 90 */
+	op_unknown1, op_unknown1, op_unknown1, op_10_93,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_10_9c,    op_unknown1, op_10_9e,    op_10_9f,
+	/* a0 */
+	op_unknown1, op_unknown1, op_unknown1, op_10_a3,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_10_ac,    op_unknown1, op_10_ae,    op_10_af,
+	/* b0 */
+	op_unknown1, op_unknown1, op_unknown1, op_10_b3,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_10_bc,    op_unknown1, op_10_be,    op_10_bf,
+	/* c0 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_10_ce,    op_unknown1,
+	/* d0 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_10_de,    op_10_df,
+	/* e0 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_10_ee,    op_10_ef,
+	/* f0 */
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_unknown1, op_unknown1,
+	op_unknown1, op_unknown1, op_10_fe,    op_10_ff
+};
+
+static void (* const ops_page2[256]) (e6809_t *c, unsigned op, unsigned *cycles) = {
+	/* 00 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* 10 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* 20 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* 30 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_11_3f,
+	/* 40 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* 50 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* 60 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* 70 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* 80 */
+	op_unknown2, op_unknown2, op_unknown2, op_11_83,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_11_8c,    op_unknown2, op_unknown2, op_unknown2,
+	/* 90 */
+	op_unknown2, op_unknown2, op_unknown2, op_11_93,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_11_9c,    op_unknown2, op_unknown2, op_unknown2,
+	/* a0 */
+	op_unknown2, op_unknown2, op_unknown2, op_11_a3,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_11_ac,    op_unknown2, op_unknown2, op_unknown2,
+	/* b0 */
+	op_unknown2, op_unknown2, op_unknown2, op_11_b3,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_11_bc,    op_unknown2, op_unknown2, op_unknown2,
+	/* c0 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* d0 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* e0 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	/* f0 */
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2,
+	op_unknown2, op_unknown2, op_unknown2, op_unknown2
+};
+
+static einline void dispatch_page1 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	*cycles += cycles_page1[op];
+
+#ifdef E6809_TABLE_DISPATCH
+	(*ops_page1[op]) (c, op, cycles);
+#else
+	switch (op) {
+	case 0x20: case 0x21: op_10_20 (c, op, cycles); break;
+	case 0x22: case 0x23: op_10_22 (c, op, cycles); break;
+	case 0x24: case 0x25: op_10_24 (c, op, cycles); break;
+	case 0x26: case 0x27: op_10_26 (c, op, cycles); break;
+	case 0x28: case 0x29: op_10_28 (c, op, cycles); break;
+	case 0x2a: case 0x2b: op_10_2a (c, op, cycles); break;
+	case 0x2c: case 0x2d: op_10_2c (c, op, cycles); break;
+	case 0x2e: case 0x2f: op_10_2e (c, op, cycles); break;
+	case 0x3f: op_10_3f (c, op, cycles); break;
+	case 0x83: op_10_83 (c, op, cycles); break;
+	case 0x8c: op_10_8c (c, op, cycles); break;
+	case 0x8e: op_10_8e (c, op, cycles); break;
+	case 0x93: op_10_93 (c, op, cycles); break;
+	case 0x9c: op_10_9c (c, op, cycles); break;
+	case 0x9e: op_10_9e (c, op, cycles); break;
+	case 0x9f: op_10_9f (c, op, cycles); break;
+	case 0xa3: op_10_a3 (c, op, cycles); break;
+	case 0xac: op_10_ac (c, op, cycles); break;
+	case 0xae: op_10_ae (c, op, cycles); break;
+	case 0xaf: op_10_af (c, op, cycles); break;
+	case 0xb3: op_10_b3 (c, op, cycles); break;
+	case 0xbc: op_10_bc (c, op, cycles); break;
+	case 0xbe: op_10_be (c, op, cycles); break;
+	case 0xbf: op_10_bf (c, op, cycles); break;
+	case 0xce: op_10_ce (c, op, cycles); break;
+	case 0xde: op_10_de (c, op, cycles); break;
+	case 0xdf: op_10_df (c, op, cycles); break;
+	case 0xee: op_10_ee (c, op, cycles); break;
+	case 0xef: op_10_ef (c, op, cycles); break;
+	case 0xfe: op_10_fe (c, op, cycles); break;
+	case 0xff: op_10_ff (c, op, cycles); break;
+	default: op_unknown1 (c, op, cycles); break;
+	}
+#endif
+}
+
+static einline void dispatch_page2 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	*cycles += cycles_page2[op];
+
+#ifdef E6809_TABLE_DISPATCH
+	(*ops_page2[op]) (c, op, cycles);
+#else
+	switch (op) {
+	case 0x3f: op_11_3f (c, op, cycles); break;
+	case 0x83: op_11_83 (c, op, cycles); break;
+	case 0x8c: op_11_8c (c, op, cycles); break;
+	case 0x93: op_11_93 (c, op, cycles); break;
+	case 0x9c: op_11_9c (c, op, cycles); break;
+	case 0xa3: op_11_a3 (c, op, cycles); break;
+	case 0xac: op_11_ac (c, op, cycles); break;
+	case 0xb3: op_11_b3 (c, op, cycles); break;
+	case 0xbc: op_11_bc (c, op, cycles); break;
+	default: op_unknown2 (c, op, cycles); break;
+	}
+#endif
+}
+
+/* page 1 and 2 prefixes */
+
+static einline void op_10 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	dispatch_page1 (c, pc_read8 (c), cycles);
+}
+
+static einline void op_11 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	dispatch_page2 (c, pc_read8 (c), cycles);
+}
+
+static void (* const ops_page0[256]) (e6809_t *c, unsigned op, unsigned *cycles) = {
+	/* 00 */
+	op_00,       op_unknown0, op_unknown0, op_03,
+	op_04,       op_unknown0, op_06,       op_07,
+	op_08,       op_09,       op_0a,       op_unknown0,
+	op_0c,       op_0d,       op_0e,       op_0f,
+	/* 10 */
+	op_10,       op_11,       op_12,       op_13,
+	op_unknown0, op_unknown0, op_16,       op_17,
+	op_unknown0, op_19,       op_1a,       op_unknown0,
+	op_1c,       op_1d,       op_1e,       op_1f,
+	/* 20 */
+	op_20,       op_20,       op_22,       op_22,
+	op_24,       op_24,       op_26,       op_26,
+	op_28,       op_28,       op_2a,       op_2a,
+	op_2c,       op_2c,       op_2e,       op_2e,
+	/* 30 */
+	op_30,       op_31,       op_32,       op_33,
+	op_34,       op_35,       op_36,       op_37,
+	op_unknown0, op_39,       op_3a,       op_3b,
+	op_3c,       op_3d,       op_unknown0, op_3f,
+	/* 40 */
+	op_40,       op_unknown0, op_unknown0, op_43,
+	op_44,       op_unknown0, op_46,       op_47,
+	op_48,       op_49,       op_4a,       op_unknown0,
+	op_4c,       op_4d,       op_unknown0, op_4f,
+	/* 50 */
+	op_50,       op_unknown0, op_unknown0, op_53,
+	op_54,       op_unknown0, op_56,       op_57,
+	op_58,       op_59,       op_5a,       op_unknown0,
+	op_5c,       op_5d,       op_unknown0, op_5f,
+	/* 60 */
+	op_60,       op_unknown0, op_unknown0, op_63,
+	op_64,       op_unknown0, op_66,       op_67,
+	op_68,       op_69,       op_6a,       op_unknown0,
+	op_6c,       op_6d,       op_6e,       op_6f,
+	/* 70 */
+	op_70,       op_unknown0, op_unknown0, op_73,
+	op_74,       op_unknown0, op_76,       op_77,
+	op_78,       op_79,       op_7a,       op_unknown0,
+	op_7c,       op_7d,       op_7e,       op_7f,
+	/* 80 */
+	op_80,       op_81,       op_82,       op_83,
+	op_84,       op_85,       op_86,       op_unknown0,
+	op_88,       op_89,       op_8a,       op_8b,
+	op_8c,       op_8d,       op_8e,       op_unknown0,
+	/* 90 */
+	op_90,       op_91,       op_92,       op_93,
+	op_94,       op_95,       op_96,       op_97,
+	op_98,       op_99,       op_9a,       op_9b,
+	op_9c,       op_9d,       op_9e,       op_9f,
+	/* a0 */
+	op_a0,       op_a1,       op_a2,       op_a3,
+	op_a4,       op_a5,       op_a6,       op_a7,
+	op_a8,       op_a9,       op_aa,       op_ab,
+	op_ac,       op_ad,       op_ae,       op_af,
+	/* b0 */
+	op_b0,       op_b1,       op_b2,       op_b3,
+	op_b4,       op_b5,       op_b6,       op_b7,
+	op_b8,       op_b9,       op_ba,       op_bb,
+	op_bc,       op_bd,       op_be,       op_bf,
+	/* c0 */
+	op_c0,       op_c1,       op_c2,       op_c3,
+	op_c4,       op_c5,       op_c6,       op_unknown0,
+	op_c8,       op_c9,       op_ca,       op_cb,
+	op_cc,       op_unknown0, op_ce,       op_unknown0,
+	/* d0 */
+	op_d0,       op_d1,       op_d2,       op_d3,
+	op_d4,       op_d5,       op_d6,       op_d7,
+	op_d8,       op_d9,       op_da,       op_db,
+	op_dc,       op_dd,       op_de,       op_df,
+	/* e0 */
+	op_e0,       op_e1,       op_e2,       op_e3,
+	op_e4,       op_e5,       op_e6,       op_e7,
+	op_e8,       op_e9,       op_ea,       op_eb,
+	op_ec,       op_ed,       op_ee,       op_ef,
+	/* f0 */
+	op_f0,       op_f1,       op_f2,       op_f3,
+	op_f4,       op_f5,       op_f6,       op_f7,
+	op_f8,       op_f9,       op_fa,       op_fb,
+	op_fc,       op_fd,       op_fe,       op_ff
+};
+
+static einline void dispatch_page0 (e6809_t *c, unsigned op, unsigned *cycles)
+{
+	*cycles += cycles_page0[op];
+
+#ifdef E6809_TABLE_DISPATCH
+	(*ops_page0[op]) (c, op, cycles);
+#else
+	switch (op) {
+	case 0x00: op_00 (c, op, cycles); break;
+	case 0x03: op_03 (c, op, cycles); break;
+	case 0x04: op_04 (c, op, cycles); break;
+	case 0x06: op_06 (c, op, cycles); break;
+	case 0x07: op_07 (c, op, cycles); break;
+	case 0x08: op_08 (c, op, cycles); break;
+	case 0x09: op_09 (c, op, cycles); break;
+	case 0x0a: op_0a (c, op, cycles); break;
+	case 0x0c: op_0c (c, op, cycles); break;
+	case 0x0d: op_0d (c, op, cycles); break;
+	case 0x0e: op_0e (c, op, cycles); break;
+	case 0x0f: op_0f (c, op, cycles); break;
+	case 0x10: op_10 (c, op, cycles); break;
+	case 0x11: op_11 (c, op, cycles); break;
+	case 0x12: op_12 (c, op, cycles); break;
+	case 0x13: op_13 (c, op, cycles); break;
+	case 0x16: op_16 (c, op, cycles); break;
+	case 0x17: op_17 (c, op, cycles); break;
+	case 0x19: op_19 (c, op, cycles); break;
+	case 0x1a: op_1a (c, op, cycles); break;
+	case 0x1c: op_1c (c, op, cycles); break;
+	case 0x1d: op_1d (c, op, cycles); break;
+	case 0x1e: op_1e (c, op, cycles); break;
+	case 0x1f: op_1f (c, op, cycles); break;
+	case 0x20: case 0x21: op_20 (c, op, cycles); break;
+	case 0x22: case 0x23: op_22 (c, op, cycles); break;
+	case 0x24: case 0x25: op_24 (c, op, cycles); break;
+	case 0x26: case 0x27: op_26 (c, op, cycles); break;
+	case 0x28: case 0x29: op_28 (c, op, cycles); break;
+	case 0x2a: case 0x2b: op_2a (c, op, cycles); break;
+	case 0x2c: case 0x2d: op_2c (c, op, cycles); break;
+	case 0x2e: case 0x2f: op_2e (c, op, cycles); break;
+	case 0x30: op_30 (c, op, cycles); break;
+	case 0x31: op_31 (c, op, cycles); break;
+	case 0x32: op_32 (c, op, cycles); break;
+	case 0x33: op_33 (c, op, cycles); break;
+	case 0x34: op_34 (c, op, cycles); break;
+	case 0x35: op_35 (c, op, cycles); break;
+	case 0x36: op_36 (c, op, cycles); break;
+	case 0x37: op_37 (c, op, cycles); break;
+	case 0x39: op_39 (c, op, cycles); break;
+	case 0x3a: op_3a (c, op, cycles); break;
+	case 0x3b: op_3b (c, op, cycles); break;
+	case 0x3c: op_3c (c, op, cycles); break;
+	case 0x3d: op_3d (c, op, cycles); break;
+	case 0x3f: op_3f (c, op, cycles); break;
+	case 0x40: op_40 (c, op, cycles); break;
+	case 0x43: op_43 (c, op, cycles); break;
+	case 0x44: op_44 (c, op, cycles); break;
+	case 0x46: op_46 (c, op, cycles); break;
+	case 0x47: op_47 (c, op, cycles); break;
+	case 0x48: op_48 (c, op, cycles); break;
+	case 0x49: op_49 (c, op, cycles); break;
+	case 0x4a: op_4a (c, op, cycles); break;
+	case 0x4c: op_4c (c, op, cycles); break;
+	case 0x4d: op_4d (c, op, cycles); break;
+	case 0x4f: op_4f (c, op, cycles); break;
+	case 0x50: op_50 (c, op, cycles); break;
+	case 0x53: op_53 (c, op, cycles); break;
+	case 0x54: op_54 (c, op, cycles); break;
+	case 0x56: op_56 (c, op, cycles); break;
+	case 0x57: op_57 (c, op, cycles); break;
+	case 0x58: op_58 (c, op, cycles); break;
+	case 0x59: op_59 (c, op, cycles); break;
+	case 0x5a: op_5a (c, op, cycles); break;
+	case 0x5c: op_5c (c, op, cycles); break;
+	case 0x5d: op_5d (c, op, cycles); break;
+	case 0x5f: op_5f (c, op, cycles); break;
+	case 0x60: op_60 (c, op, cycles); break;
+	case 0x63: op_63 (c, op, cycles); break;
+	case 0x64: op_64 (c, op, cycles); break;
+	case 0x66: op_66 (c, op, cycles); break;
+	case 0x67: op_67 (c, op, cycles); break;
+	case 0x68: op_68 (c, op, cycles); break;
+	case 0x69: op_69 (c, op, cycles); break;
+	case 0x6a: op_6a (c, op, cycles); break;
+	case 0x6c: op_6c (c, op, cycles); break;
+	case 0x6d: op_6d (c, op, cycles); break;
+	case 0x6e: op_6e (c, op, cycles); break;
+	case 0x6f: op_6f (c, op, cycles); break;
+	case 0x70: op_70 (c, op, cycles); break;
+	case 0x73: op_73 (c, op, cycles); break;
+	case 0x74: op_74 (c, op, cycles); break;
+	case 0x76: op_76 (c, op, cycles); break;
+	case 0x77: op_77 (c, op, cycles); break;
+	case 0x78: op_78 (c, op, cycles); break;
+	case 0x79: op_79 (c, op, cycles); break;
+	case 0x7a: op_7a (c, op, cycles); break;
+	case 0x7c: op_7c (c, op, cycles); break;
+	case 0x7d: op_7d (c, op, cycles); break;
+	case 0x7e: op_7e (c, op, cycles); break;
+	case 0x7f: op_7f (c, op, cycles); break;
+	case 0x80: op_80 (c, op, cycles); break;
+	case 0x81: op_81 (c, op, cycles); break;
+	case 0x82: op_82 (c, op, cycles); break;
+	case 0x83: op_83 (c, op, cycles); break;
+	case 0x84: op_84 (c, op, cycles); break;
+	case 0x85: op_85 (c, op, cycles); break;
+	case 0x86: op_86 (c, op, cycles); break;
+	case 0x88: op_88 (c, op, cycles); break;
+	case 0x89: op_89 (c, op, cycles); break;
+	case 0x8a: op_8a (c, op, cycles); break;
+	case 0x8b: op_8b (c, op, cycles); break;
+	case 0x8c: op_8c (c, op, cycles); break;
+	case 0x8d: op_8d (c, op, cycles); break;
+	case 0x8e: op_8e (c, op, cycles); break;
+	case 0x90: op_90 (c, op, cycles); break;
+	case 0x91: op_91 (c, op, cycles); break;
+	case 0x92: op_92 (c, op, cycles); break;
+	case 0x93: op_93 (c, op, cycles); break;
+	case 0x94: op_94 (c, op, cycles); break;
+	case 0x95: op_95 (c, op, cycles); break;
+	case 0x96: op_96 (c, op, cycles); break;
+	case 0x97: op_97 (c, op, cycles); break;
+	case 0x98: op_98 (c, op, cycles); break;
+	case 0x99: op_99 (c, op, cycles); break;
+	case 0x9a: op_9a (c, op, cycles); break;
+	case 0x9b: op_9b (c, op, cycles); break;
+	case 0x9c: op_9c (c, op, cycles); break;
+	case 0x9d: op_9d (c, op, cycles); break;
+	case 0x9e: op_9e (c, op, cycles); break;
+	case 0x9f: op_9f (c, op, cycles); break;
+	case 0xa0: op_a0 (c, op, cycles); break;
+	case 0xa1: op_a1 (c, op, cycles); break;
+	case 0xa2: op_a2 (c, op, cycles); break;
+	case 0xa3: op_a3 (c, op, cycles); break;
+	case 0xa4: op_a4 (c, op, cycles); break;
+	case 0xa5: op_a5 (c, op, cycles); break;
+	case 0xa6: op_a6 (c, op, cycles); break;
+	case 0xa7: op_a7 (c, op, cycles); break;
+	case 0xa8: op_a8 (c, op, cycles); break;
+	case 0xa9: op_a9 (c, op, cycles); break;
+	case 0xaa: op_aa (c, op, cycles); break;
+	case 0xab: op_ab (c, op, cycles); break;
+	case 0xac: op_ac (c, op, cycles); break;
+	case 0xad: op_ad (c, op, cycles); break;
+	case 0xae: op_ae (c, op, cycles); break;
+	case 0xaf: op_af (c, op, cycles); break;
+	case 0xb0: op_b0 (c, op, cycles); break;
+	case 0xb1: op_b1 (c, op, cycles); break;
+	case 0xb2: op_b2 (c, op, cycles); break;
+	case 0xb3: op_b3 (c, op, cycles); break;
+	case 0xb4: op_b4 (c, op, cycles); break;
+	case 0xb5: op_b5 (c, op, cycles); break;
+	case 0xb6: op_b6 (c, op, cycles); break;
+	case 0xb7: op_b7 (c, op, cycles); break;
+	case 0xb8: op_b8 (c, op, cycles); break;
+	case 0xb9: op_b9 (c, op, cycles); break;
+	case 0xba: op_ba (c, op, cycles); break;
+	case 0xbb: op_bb (c, op, cycles); break;
+	case 0xbc: op_bc (c, op, cycles); break;
+	case 0xbd: op_bd (c, op, cycles); break;
+	case 0xbe: op_be (c, op, cycles); break;
+	case 0xbf: op_bf (c, op, cycles); break;
+	case 0xc0: op_c0 (c, op, cycles); break;
+	case 0xc1: op_c1 (c, op, cycles); break;
+	case 0xc2: op_c2 (c, op, cycles); break;
+	case 0xc3: op_c3 (c, op, cycles); break;
+	case 0xc4: op_c4 (c, op, cycles); break;
+	case 0xc5: op_c5 (c, op, cycles); break;
+	case 0xc6: op_c6 (c, op, cycles); break;
+	case 0xc8: op_c8 (c, op, cycles); break;
+	case 0xc9: op_c9 (c, op, cycles); break;
+	case 0xca: op_ca (c, op, cycles); break;
+	case 0xcb: op_cb (c, op, cycles); break;
+	case 0xcc: op_cc (c, op, cycles); break;
+	case 0xce: op_ce (c, op, cycles); break;
+	case 0xd0: op_d0 (c, op, cycles); break;
+	case 0xd1: op_d1 (c, op, cycles); break;
+	case 0xd2: op_d2 (c, op, cycles); break;
+	case 0xd3: op_d3 (c, op, cycles); break;
+	case 0xd4: op_d4 (c, op, cycles); break;
+	case 0xd5: op_d5 (c, op, cycles); break;
+	case 0xd6: op_d6 (c, op, cycles); break;
+	case 0xd7: op_d7 (c, op, cycles); break;
+	case 0xd8: op_d8 (c, op, cycles); break;
+	case 0xd9: op_d9 (c, op, cycles); break;
+	case 0xda: op_da (c, op, cycles); break;
+	case 0xdb: op_db (c, op, cycles); break;
+	case 0xdc: op_dc (c, op, cycles); break;
+	case 0xdd: op_dd (c, op, cycles); break;
+	case 0xde: op_de (c, op, cycles); break;
+	case 0xdf: op_df (c, op, cycles); break;
+	case 0xe0: op_e0 (c, op, cycles); break;
+	case 0xe1: op_e1 (c, op, cycles); break;
+	case 0xe2: op_e2 (c, op, cycles); break;
+	case 0xe3: op_e3 (c, op, cycles); break;
+	case 0xe4: op_e4 (c, op, cycles); break;
+	case 0xe5: op_e5 (c, op, cycles); break;
+	case 0xe6: op_e6 (c, op, cycles); break;
+	case 0xe7: op_e7 (c, op, cycles); break;
+	case 0xe8: op_e8 (c, op, cycles); break;
+	case 0xe9: op_e9 (c, op, cycles); break;
+	case 0xea: op_ea (c, op, cycles); break;
+	case 0xeb: op_eb (c, op, cycles); break;
+	case 0xec: op_ec (c, op, cycles); break;
+	case 0xed: op_ed (c, op, cycles); break;
+	case 0xee: op_ee (c, op, cycles); break;
+	case 0xef: op_ef (c, op, cycles); break;
+	case 0xf0: op_f0 (c, op, cycles); break;
+	case 0xf1: op_f1 (c, op, cycles); break;
+	case 0xf2: op_f2 (c, op, cycles); break;
+	case 0xf3: op_f3 (c, op, cycles); break;
+	case 0xf4: op_f4 (c, op, cycles); break;
+	case 0xf5: op_f5 (c, op, cycles); break;
+	case 0xf6: op_f6 (c, op, cycles); break;
+	case 0xf7: op_f7 (c, op, cycles); break;
+	case 0xf8: op_f8 (c, op, cycles); break;
+	case 0xf9: op_f9 (c, op, cycles); break;
+	case 0xfa: op_fa (c, op, cycles); break;
+	case 0xfb: op_fb (c, op, cycles); break;
+	case 0xfc: op_fc (c, op, cycles); break;
+	case 0xfd: op_fd (c, op, cycles); break;
+	case 0xfe: op_fe (c, op, cycles); break;
+	case 0xff: op_ff (c, op, cycles); break;
+	default: op_unknown0 (c, op, cycles); break;
+	}
+#endif
+}
+
+/* decoded instruction cache. code in read-only pages (rom and cartridge)
+ * is decoded once per address into the handler, opcode, base cycles and
+ * opcode length, so executing it again skips the fetch of the opcode and
+ * prefix bytes and the dispatch on them. code in ram is never cached and
+ * always decoded from memory.
+ */
+
+static void dcache_decode (e6809_t *c, e6809_dcache_t *d, unsigned pc)
+{
+	unsigned op;
+
+	op = read8 (c, pc);
+
+	if (op == 0x10) {
+		op = read8 (c, pc + 1);
+		d->fn = ops_page1[op];
+		d->cycles = cycles_page1[op];
+		d->len = 2;
+	} else if (op == 0x11) {
+		op = read8 (c, pc + 1);
+		d->fn = ops_page2[op];
+		d->cycles = cycles_page2[op];
+		d->len = 2;
+	} else {
+		d->fn = ops_page0[op];
+		d->cycles = cycles_page0[op];
+		d->len = 1;
+	}
+
+	d->op = (unsigned char) op;
+}
+
+static einline void dcache_exec (e6809_t *c, unsigned *cycles)
+{
+	e6809_dcache_t *d;
+	unsigned p;
+
+	p = (c->reg_pc >> 8) & 0xff;
+
+	if (c->dcache[p] == NULL) {
+		c->dcache[p] = calloc (256, sizeof (*c->dcache[p]));
+
+		if (c->dcache[p] == NULL) {
+			/* out of memory, decode from memory every time */
+
+			dispatch_page0 (c, pc_read8 (c), cycles);
+			return;
+		}
+	}
+
+	d = c->dcache[p] + (c->reg_pc & 0xff);
+
+	if (d->fn == NULL) {
+		dcache_decode (c, d, c->reg_pc);
+	}
+
+	c->reg_pc += d->len;
+	*cycles += d->cycles;
+	(*d->fn) (c, d->op, cycles);
+}
+
+static void dcache_free (e6809_t *c)
+{
+	unsigned p;
+
+	for (p = 0; p < 256; p++) {
+		free (c->dcache[p]);
+		c->dcache[p] = NULL;
+	}
+}
+
+/* throw away all decoded instructions and find the read-only pages. a page
+ * is read-only if reads come straight from memory and writes go somewhere
+ * else. an instruction may straddle into the next page, so both must be
+ * read-only.
+ */
+
+static void dcache_reset (e6809_t *c)
+{
+	unsigned p;
+
+	dcache_free (c);
+
+	for (p = 0; p < 256; p++) {
+		c->dcache_page[p] = c->rmap[p] != NULL && c->wmap[p] != NULL &&
+						 c->wmap[p] != c->rmap[p];
+	}
+
+	for (p = 0; p < 256; p++) {
+		c->dcache_page[p] &= c->dcache_page[(p + 1) & 0xff];
+	}
+}
+
+#ifdef E6809_JIT
+
+/* block compiler. this is subroutine threading rather than translation:
+ * hot straight-line runs of rom or cartridge code become x86-64 call stubs
+ * which, for every instruction, set reg_pc past the opcode, add the base
+ * cycles, call the interpreter's own handler and check that reg_pc ended
+ * up past the operands. no instruction is turned into native code. all it
+ * saves is the fetch, the decoded cache lookup and the trip round the
+ * e6809_run loop between instructions. on the bios intro that is about 10%
+ * over the decoded interpreter without hle. with hle most of what is left
+ * polls the via, those blocks fall back to the interpreter, and the lookups
+ * make it a little slower than hle alone. instructions that change the
+ * flow of control, cc or interrupt state end a block, as do pcs marked
+ * through e6809_idle_pc or e6809_hle_pc.
+ *
+ * a block only runs if both irq and firq are masked, so no interrupt can
+ * be missed inside it, and if it cannot exhaust the e6809_run budget. if a
+ * block ever touches a trapped (io) page, sync is called to catch the
+ * peripherals up first and the block is not used again.
+ */
+
+enum {
+	JIT_HOT			= 16,			/* executions before a block is compiled */
+	JIT_INSNS		= 32,			/* instructions per block at most */
+	JIT_SLACK		= 20,			/* extra cycles an instruction may add */
+	JIT_CODE_MIN	= 64 << 10,		/* first code buffer */
+	JIT_CODE_MAX	= 4 << 20		/* largest it grows to */
+};
+
+/* opcodes which end a block: everything that may write reg_pc other than
+ * by stepping past its operands (branches, jumps, calls, returns, swi,
+ * swi2, swi3, puls/pulu, tfr/exg), change cc or wait for an interrupt.
+ * should one be missed, the check compiled in after every instruction
+ * still leaves the block as soon as reg_pc is not where it should be.
+ */
+
+static unsigned jit_ends (unsigned page, unsigned op)
+{
+	if (page == 1) {
+		return (op >= 0x20 && op <= 0x2f) || op == 0x3f || ops_page1[op] == op_unknown1;
+	} else if (page == 2) {
+		return op == 0x3f || ops_page2[op] == op_unknown2;
+	}
+
+	switch (op) {
+	case 0x0e: case 0x13: case 0x16: case 0x17:
+	case 0x1a: case 0x1c: case 0x1e: case 0x1f:
+	case 0x35: case 0x37: case 0x39: case 0x3b:
+	case 0x3c: case 0x3f: case 0x6e: case 0x7e:
+	case 0x8d: case 0x9d: case 0xad: case 0xbd:
+		return 1;
+	}
+
+	return (op >= 0x20 && op <= 0x2f) || ops_page0[op] == op_unknown0;
+}
+
+/* number of operand bytes following the opcode at pc */
+
+static unsigned jit_operands (e6809_t *c, unsigned page, unsigned op, unsigned pc)
+{
+	unsigned post;
+
+	switch (op >> 4) {
+	case 0x0: case 0x9: case 0xd:
+		return 1;
+	case 0x7: case 0xb: case 0xf:
+		return 2;
+	case 0x8: case 0xc:
+		if (page != 0 || (op & 0x0f) == 0x03 ||
+			(op & 0x0f) == 0x0c || (op & 0x0f) == 0x0e) {
+			return 2;
+		}
+
+		return 1;
+	case 0x2:
+		return (page != 0) ? 2 : 1;
+	case 0x1:
+		if (op == 0x16 || op == 0x17) {
+			return 2;
+		}
+
+		return (op == 0x1a || op == 0x1c || op == 0x1e || op == 0x1f) ? 1 : 0;
+	case 0x3:
+		if (op >= 0x34 && op <= 0x37) {
+			return 1;
+		}
+
+		if (op == 0x3c) {
+			return 1;
+		}
+
+		if (op > 0x33) {
+			return 0;
+		}
+
+		/* lea, indexed */
 
-	switch (op) {
-	/* page 0 instructions */
-
-	/* neg, nega, negb */
-	case 0x00:
-		ea = ea_direct ();
-		r = inst_neg (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x40:
-		reg_a = inst_neg (reg_a);
-		cycles += 2;
-		break;
-	case 0x50:
-		reg_b = inst_neg (reg_b);
-		cycles += 2;
-		break;
-	case 0x60:
-		ea = ea_indexed (&cycles);
-		r = inst_neg (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x70:
-		ea = ea_extended ();
-		r = inst_neg (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* com, coma, comb */
-	case 0x03:
-		ea = ea_direct ();
-		r = inst_com (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x43:
-		reg_a = inst_com (reg_a);
-		cycles += 2;
-		break;
-	case 0x53:
-		reg_b = inst_com (reg_b);
-		cycles += 2;
-		break;
-	case 0x63:
-		ea = ea_indexed (&cycles);
-		r = inst_com (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x73:
-		ea = ea_extended ();
-		r = inst_com (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* lsr, lsra, lsrb */
-	case 0x04:
-		ea = ea_direct ();
-		r = inst_lsr (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x44:
-		reg_a = inst_lsr (reg_a);
-		cycles += 2;
-		break;
-	case 0x54:
-		reg_b = inst_lsr (reg_b);
-		cycles += 2;
-		break;
-	case 0x64:
-		ea = ea_indexed (&cycles);
-		r = inst_lsr (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x74:
-		ea = ea_extended ();
-		r = inst_lsr (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* ror, rora, rorb */
-	case 0x06:
-		ea = ea_direct ();
-		r = inst_ror (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x46:
-		reg_a = inst_ror (reg_a);
-		cycles += 2;
-		break;
-	case 0x56:
-		reg_b = inst_ror (reg_b);
-		cycles += 2;
-		break;
-	case 0x66:
-		ea = ea_indexed (&cycles);
-		r = inst_ror (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x76:
-		ea = ea_extended ();
-		r = inst_ror (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* asr, asra, asrb */
-	case 0x07:
-		ea = ea_direct ();
-		r = inst_asr (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x47:
-		reg_a = inst_asr (reg_a);
-		cycles += 2;
-		break;
-	case 0x57:
-		reg_b = inst_asr (reg_b);
-		cycles += 2;
-		break;
-	case 0x67:
-		ea = ea_indexed (&cycles);
-		r = inst_asr (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x77:
-		ea = ea_extended ();
-		r = inst_asr (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* asl, asla, aslb */
-	case 0x08:
-		ea = ea_direct ();
-		r = inst_asl (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x48:
-		reg_a = inst_asl (reg_a);
-		cycles += 2;
-		break;
-	case 0x58:
-		reg_b = inst_asl (reg_b);
-		cycles += 2;
-		break;
-	case 0x68:
-		ea = ea_indexed (&cycles);
-		r = inst_asl (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x78:
-		ea = ea_extended ();
-		r = inst_asl (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* rol, rola, rolb */
-	case 0x09:
-		ea = ea_direct ();
-		r = inst_rol (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x49:
-		reg_a = inst_rol (reg_a);
-		cycles += 2;
-		break;
-	case 0x59:
-		reg_b = inst_rol (reg_b);
-		cycles += 2;
-		break;
-	case 0x69:
-		ea = ea_indexed (&cycles);
-		r = inst_rol (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x79:
-		ea = ea_extended ();
-		r = inst_rol (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* dec, deca, decb */
-	case 0x0a:
-		ea = ea_direct ();
-		r = inst_dec (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x4a:
-		reg_a = inst_dec (reg_a);
-		cycles += 2;
-		break;
-	case 0x5a:
-		reg_b = inst_dec (reg_b);
-		cycles += 2;
-		break;
-	case 0x6a:
-		ea = ea_indexed (&cycles);
-		r = inst_dec (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x7a:
-		ea = ea_extended ();
-		r = inst_dec (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* inc, inca, incb */
-	case 0x0c:
-		ea = ea_direct ();
-		r = inst_inc (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x4c:
-		reg_a = inst_inc (reg_a);
-		cycles += 2;
-		break;
-	case 0x5c:
-		reg_b = inst_inc (reg_b);
-		cycles += 2;
-		break;
-	case 0x6c:
-		ea = ea_indexed (&cycles);
-		r = inst_inc (read8 (ea));
-		write8 (ea, r);
-		cycles += 6;
-		break;
-	case 0x7c:
-		ea = ea_extended ();
-		r = inst_inc (read8 (ea));
-		write8 (ea, r);
-		cycles += 7;
-		break;
-	/* tst, tsta, tstb */
-	case 0x0d:
-		ea = ea_direct ();
-		inst_tst8 (read8 (ea));
-		cycles += 6;
-		break;
-	case 0x4d:
-		inst_tst8 (reg_a);
-		cycles += 2;
-		break;
-	case 0x5d:
-		inst_tst8 (reg_b);
-		cycles += 2;
-		break;
-	case 0x6d:
-		ea = ea_indexed (&cycles);
-		inst_tst8 (read8 (ea));
-		cycles += 6;
-		break;
-	case 0x7d:
-		ea = ea_extended ();
-		inst_tst8 (read8 (ea));
-		cycles += 7;
-		break;
-	/* jmp */
-	case 0x0e:
-		reg_pc = ea_direct ();
-		cycles += 3;
-		break;
-	case 0x6e:
-		reg_pc = ea_indexed (&cycles);
-		cycles += 3;
-		break;
-	case 0x7e:
-		reg_pc = ea_extended ();
-		cycles += 4;
-		break;
-	/* clr */
-	case 0x0f:
-		ea = ea_direct ();
-		inst_clr ();
-		write8 (ea, 0);
-		cycles += 6;
-		break;
-	case 0x4f:
-		inst_clr ();
-		reg_a = 0;
-		cycles += 2;
-		break;
-	case 0x5f:
-		inst_clr ();
-		reg_b = 0;
-		cycles += 2;
-		break;
-	case 0x6f:
-		ea = ea_indexed (&cycles);
-		inst_clr ();
-		write8 (ea, 0);
-		cycles += 6;
-		break;
-	case 0x7f:
-		ea = ea_extended ();
-		inst_clr ();
-		write8 (ea, 0);
-		cycles += 7;
-		break;
-	/* suba */
-	case 0x80:
-		reg_a = inst_sub8 (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x90:
-		ea = ea_direct ();
-		reg_a = inst_sub8 (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xa0:
-		ea = ea_indexed (&cycles);
-		reg_a = inst_sub8 (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xb0:
-		ea = ea_extended ();
-		reg_a = inst_sub8 (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* subb */
-	case 0xc0:
-		reg_b = inst_sub8 (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xd0:
-		ea = ea_direct ();
-		reg_b = inst_sub8 (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xe0:
-		ea = ea_indexed (&cycles);
-		reg_b = inst_sub8 (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xf0:
-		ea = ea_extended ();
-		reg_b = inst_sub8 (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* cmpa */
-	case 0x81:
-		inst_sub8 (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x91:
-		ea = ea_direct ();
-		inst_sub8 (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xa1:
-		ea = ea_indexed (&cycles);
-		inst_sub8 (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xb1:
-		ea = ea_extended ();
-		inst_sub8 (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* cmpb */
-	case 0xc1:
-		inst_sub8 (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xd1:
-		ea = ea_direct ();
-		inst_sub8 (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xe1:
-		ea = ea_indexed (&cycles);
-		inst_sub8 (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xf1:
-		ea = ea_extended ();
-		inst_sub8 (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* sbca */
-	case 0x82:
-		reg_a = inst_sbc (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x92:
-		ea = ea_direct ();
-		reg_a = inst_sbc (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xa2:
-		ea = ea_indexed (&cycles);
-		reg_a = inst_sbc (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xb2:
-		ea = ea_extended ();
-		reg_a = inst_sbc (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* sbcb */
-	case 0xc2:
-		reg_b = inst_sbc (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xd2:
-		ea = ea_direct ();
-		reg_b = inst_sbc (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xe2:
-		ea = ea_indexed (&cycles);
-		reg_b = inst_sbc (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xf2:
-		ea = ea_extended ();
-		reg_b = inst_sbc (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* anda */
-	case 0x84:
-		reg_a = inst_and (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x94:
-		ea = ea_direct ();
-		reg_a = inst_and (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xa4:
-		ea = ea_indexed (&cycles);
-		reg_a = inst_and (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xb4:
-		ea = ea_extended ();
-		reg_a = inst_and (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* andb */
-	case 0xc4:
-		reg_b = inst_and (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xd4:
-		ea = ea_direct ();
-		reg_b = inst_and (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xe4:
-		ea = ea_indexed (&cycles);
-		reg_b = inst_and (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xf4:
-		ea = ea_extended ();
-		reg_b = inst_and (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* bita */
-	case 0x85:
-		inst_and (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x95:
-		ea = ea_direct ();
-		inst_and (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xa5:
-		ea = ea_indexed (&cycles);
-		inst_and (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xb5:
-		ea = ea_extended ();
-		inst_and (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* bitb */
-	case 0xc5:
-		inst_and (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xd5:
-		ea = ea_direct ();
-		inst_and (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xe5:
-		ea = ea_indexed (&cycles);
-		inst_and (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xf5:
-		ea = ea_extended ();
-		inst_and (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* lda */
-	case 0x86:
-		reg_a = pc_read8 ();
-		inst_tst8 (reg_a);
-		cycles += 2;
-		break;
-	case 0x96:
-		ea = ea_direct ();
-		reg_a = read8 (ea);
-		inst_tst8 (reg_a);
-		cycles += 4;
-		break;
-	case 0xa6:
-		ea = ea_indexed (&cycles);
-		reg_a = read8 (ea);
-		inst_tst8 (reg_a);
-		cycles += 4;
-		break;
-	case 0xb6:
-		ea = ea_extended ();
-		reg_a = read8 (ea);
-		inst_tst8 (reg_a);
-		cycles += 5;
-		break;
-	/* ldb */
-	case 0xc6:
-		reg_b = pc_read8 ();
-		inst_tst8 (reg_b);
-		cycles += 2;
-		break;
-	case 0xd6:
-		ea = ea_direct ();
-		reg_b = read8 (ea);
-		inst_tst8 (reg_b);
-		cycles += 4;
-		break;
-	case 0xe6:
-		ea = ea_indexed (&cycles);
-		reg_b = read8 (ea);
-		inst_tst8 (reg_b);
-		cycles += 4;
-		break;
-	case 0xf6:
-		ea = ea_extended ();
-		reg_b = read8 (ea);
-		inst_tst8 (reg_b);
-		cycles += 5;
-		break;
-	/* sta */
-	case 0x97:
-		ea = ea_direct ();
-		write8 (ea, reg_a);
-		inst_tst8 (reg_a);
-		cycles += 4;
-		break;
-	case 0xa7:
-		ea = ea_indexed (&cycles);
-		write8 (ea, reg_a);
-		inst_tst8 (reg_a);
-		cycles += 4;
-		break;
-	case 0xb7:
-		ea = ea_extended ();
-		write8 (ea, reg_a);
-		inst_tst8 (reg_a);
-		cycles += 5;
-		break;
-	/* stb */
-	case 0xd7:
-		ea = ea_direct ();
-		write8 (ea, reg_b);
-		inst_tst8 (reg_b);
-		cycles += 4;
-		break;
-	case 0xe7:
-		ea = ea_indexed (&cycles);
-		write8 (ea, reg_b);
-		inst_tst8 (reg_b);
-		cycles += 4;
-		break;
-	case 0xf7:
-		ea = ea_extended ();
-		write8 (ea, reg_b);
-		inst_tst8 (reg_b);
-		cycles += 5;
-		break;
-	/* eora */
-	case 0x88:
-		reg_a = inst_eor (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x98:
-		ea = ea_direct ();
-		reg_a = inst_eor (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xa8:
-		ea = ea_indexed (&cycles);
-		reg_a = inst_eor (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xb8:
-		ea = ea_extended ();
-		reg_a = inst_eor (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* eorb */
-	case 0xc8:
-		reg_b = inst_eor (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xd8:
-		ea = ea_direct ();
-		reg_b = inst_eor (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xe8:
-		ea = ea_indexed (&cycles);
-		reg_b = inst_eor (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xf8:
-		ea = ea_extended ();
-		reg_b = inst_eor (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* adca */
-	case 0x89:
-		reg_a = inst_adc (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x99:
-		ea = ea_direct ();
-		reg_a = inst_adc (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xa9:
-		ea = ea_indexed (&cycles);
-		reg_a = inst_adc (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xb9:
-		ea = ea_extended ();
-		reg_a = inst_adc (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* adcb */
-	case 0xc9:
-		reg_b = inst_adc (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xd9:
-		ea = ea_direct ();
-		reg_b = inst_adc (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xe9:
-		ea = ea_indexed (&cycles);
-		reg_b = inst_adc (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xf9:
-		ea = ea_extended ();
-		reg_b = inst_adc (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* ora */
-	case 0x8a:
-		reg_a = inst_or (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x9a:
-		ea = ea_direct ();
-		reg_a = inst_or (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xaa:
-		ea = ea_indexed (&cycles);
-		reg_a = inst_or (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xba:
-		ea = ea_extended ();
-		reg_a = inst_or (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* orb */
-	case 0xca:
-		reg_b = inst_or (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xda:
-		ea = ea_direct ();
-		reg_b = inst_or (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xea:
-		ea = ea_indexed (&cycles);
-		reg_b = inst_or (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xfa:
-		ea = ea_extended ();
-		reg_b = inst_or (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* adda */
-	case 0x8b:
-		reg_a = inst_add8 (reg_a, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0x9b:
-		ea = ea_direct ();
-		reg_a = inst_add8 (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xab:
-		ea = ea_indexed (&cycles);
-		reg_a = inst_add8 (reg_a, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xbb:
-		ea = ea_extended ();
-		reg_a = inst_add8 (reg_a, read8 (ea));
-		cycles += 5;
-		break;
-	/* addb */
-	case 0xcb:
-		reg_b = inst_add8 (reg_b, pc_read8 ());
-		cycles += 2;
-		break;
-	case 0xdb:
-		ea = ea_direct ();
-		reg_b = inst_add8 (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xeb:
-		ea = ea_indexed (&cycles);
-		reg_b = inst_add8 (reg_b, read8 (ea));
-		cycles += 4;
-		break;
-	case 0xfb:
-		ea = ea_extended ();
-		reg_b = inst_add8 (reg_b, read8 (ea));
-		cycles += 5;
-		break;
-	/* subd */
-	case 0x83:
-		set_reg_d (inst_sub16 (get_reg_d (), pc_read16 ()));
-		cycles += 4;
-		break;
-	case 0x93:
-		ea = ea_direct ();
-		set_reg_d (inst_sub16 (get_reg_d (), read16 (ea)));
-		cycles += 6;
-		break;
-	case 0xa3:
-		ea = ea_indexed (&cycles);
-		set_reg_d (inst_sub16 (get_reg_d (), read16 (ea)));
-		cycles += 6;
-		break;
-	case 0xb3:
-		ea = ea_extended ();
-		set_reg_d (inst_sub16 (get_reg_d (), read16 (ea)));
-		cycles += 7;
-		break;
-	/* cmpx */
-	case 0x8c:
-		inst_sub16 (reg_x, pc_read16 ());
-		cycles += 4;
-		break;
-	case 0x9c:
-		ea = ea_direct ();
-		inst_sub16 (reg_x, read16 (ea));
-		cycles += 6;
-		break;
-	case 0xac:
-		ea = ea_indexed (&cycles);
-		inst_sub16 (reg_x, read16 (ea));
-		cycles += 6;
-		break;
-	case 0xbc:
-		ea = ea_extended ();
-		inst_sub16 (reg_x, read16 (ea));
-		cycles += 7;
-		break;
-	/* ldx */
-	case 0x8e:
-		reg_x = pc_read16 ();
-		inst_tst16 (reg_x);
-		cycles += 3;
-		break;
-	case 0x9e: 
-		ea = ea_direct ();
-		reg_x = read16 (ea);
-		inst_tst16 (reg_x);
-		cycles += 5;
-		break;
-	case 0xae:
-		ea = ea_indexed (&cycles);
-		reg_x = read16 (ea);
-		inst_tst16 (reg_x);
-		cycles += 5;
-		break;
-	case 0xbe:
-		ea = ea_extended ();
-		reg_x = read16 (ea);
-		inst_tst16 (reg_x);
-		cycles += 6;
-		break;
-	/* ldu */
-	case 0xce:
-		reg_u = pc_read16 ();
-		inst_tst16 (reg_u);
-		cycles += 3;
-		break;
-	case 0xde: 
-		ea = ea_direct ();
-		reg_u = read16 (ea);
-		inst_tst16 (reg_u);
-		cycles += 5;
-		break;
-	case 0xee:
-		ea = ea_indexed (&cycles);
-		reg_u = read16 (ea);
-		inst_tst16 (reg_u);
-		cycles += 5;
-		break;
-	case 0xfe:
-		ea = ea_extended ();
-		reg_u = read16 (ea);
-		inst_tst16 (reg_u);
-		cycles += 6;
-		break;
-	/* stx */
-	case 0x9f:
-		ea = ea_direct ();
-		write16 (ea, reg_x);
-		inst_tst16 (reg_x);
-		cycles += 5;
-		break;
-	case 0xaf:
-		ea = ea_indexed (&cycles);
-		write16 (ea, reg_x);
-		inst_tst16 (reg_x);
-		cycles += 5;
-		break;
-	case 0xbf:
-		ea = ea_extended ();
-		write16 (ea, reg_x);
-		inst_tst16 (reg_x);
-		cycles += 6;
-		break;
-	/* stu */
-	case 0xdf:
-		ea = ea_direct ();
-		write16 (ea, reg_u);
-		inst_tst16 (reg_u);
-		cycles += 5;
-		break;
-	case 0xef:
-		ea = ea_indexed (&cycles);
-		write16 (ea, reg_u);
-		inst_tst16 (reg_u);
-		cycles += 5;
-		break;
-	case 0xff:
-		ea = ea_extended ();
-		write16 (ea, reg_u);
-		inst_tst16 (reg_u);
-		cycles += 6;
-		break;
-	/* addd */
-	case 0xc3:
-		set_reg_d (inst_add16 (get_reg_d (), pc_read16 ()));
-		cycles += 4;
-		break;
-	case 0xd3:
-		ea = ea_direct ();
-		set_reg_d (inst_add16 (get_reg_d (), read16 (ea)));
-		cycles += 6;
-		break;
-	case 0xe3:
-		ea = ea_indexed (&cycles);
-		set_reg_d (inst_add16 (get_reg_d (), read16 (ea)));
-		cycles += 6;
-		break;
-	case 0xf3:
-		ea = ea_extended ();
-		set_reg_d (inst_add16 (get_reg_d (), read16 (ea)));
-		cycles += 7;
-		break;
-	/* ldd */
-	case 0xcc:
-		set_reg_d (pc_read16 ());
-		inst_tst16 (get_reg_d ());
-		cycles += 3;
-		break;
-	case 0xdc: 
-		ea = ea_direct ();
-		set_reg_d (read16 (ea));
-		inst_tst16 (get_reg_d ());
-		cycles += 5;
-		break;
-	case 0xec:
-		ea = ea_indexed (&cycles);
-		set_reg_d (read16 (ea));
-		inst_tst16 (get_reg_d ());
-		cycles += 5;
-		break;
-	case 0xfc:
-		ea = ea_extended ();
-		set_reg_d (read16 (ea));
-		inst_tst16 (get_reg_d ());
-		cycles += 6;
-		break;
-	/* std */
-	case 0xdd:
-		ea = ea_direct ();
-		write16 (ea, get_reg_d ());
-		inst_tst16 (get_reg_d ());
-		cycles += 5;
-		break;
-	case 0xed:
-		ea = ea_indexed (&cycles);
-		write16 (ea, get_reg_d ());
-		inst_tst16 (get_reg_d ());
-		cycles += 5;
-		break;
-	case 0xfd:
-		ea = ea_extended ();
-		write16 (ea, get_reg_d ());
-		inst_tst16 (get_reg_d ());
-		cycles += 6;
-		break;
-	/* nop */
-	case 0x12:
-		cycles += 2;
-		break;
-	/* mul */
-	case 0x3d:
-		r = (reg_a & 0xff) * (reg_b & 0xff);
-		set_reg_d (r);
-
-		set_cc (FLAG_Z, test_z16 (r));
-		set_cc (FLAG_C, (r >> 7) & 1);
-		
-		cycles += 11;
-		break;
-	/* bra */
-	case 0x20:
-	/* brn */
-	case 0x21:
-		inst_bra8 (0, op, &cycles);
-		break;
-	/* bhi */
-	case 0x22:
-	/* bls */
-	case 0x23:
-		inst_bra8 (get_cc (FLAG_C) | get_cc (FLAG_Z), op, &cycles);
-		break;
-	/* bhs/bcc */
-	case 0x24:
-	/* blo/bcs */
-	case 0x25:
-		inst_bra8 (get_cc (FLAG_C), op, &cycles);
-		break;
-	/* bne */
-	case 0x26:
-	/* beq */
-	case 0x27:
-		inst_bra8 (get_cc (FLAG_Z), op, &cycles);
-		break;
-	/* bvc */
-	case 0x28:
-	/* bvs */
-	case 0x29:
-		inst_bra8 (get_cc (FLAG_V), op, &cycles);
-		break;
-	/* bpl */
-	case 0x2a:
-	/* bmi */
-	case 0x2b:
-		inst_bra8 (get_cc (FLAG_N), op, &cycles);
-		break;
-	/* bge */
-	case 0x2c:
-	/* blt */
-	case 0x2d:
-		inst_bra8 (get_cc (FLAG_N) ^ get_cc (FLAG_V), op, &cycles);
-		break;
-	/* bgt */
-	case 0x2e:
-	/* ble */
-	case 0x2f:
-		inst_bra8 (get_cc (FLAG_Z) |
-				   (get_cc (FLAG_N) ^ get_cc (FLAG_V)), op, &cycles);
-		break;
-	/* lbra */
-	case 0x16:
-		r = pc_read16 ();
-		reg_pc += r;
-		cycles += 5;
-		break;
-	/* lbsr */
-	case 0x17:
-		r = pc_read16 ();
-		push16 (&reg_s, reg_pc);
-		reg_pc += r;
-		cycles += 9;
-		break;
-	/* bsr */
-	case 0x8d:
-		r = pc_read8 ();
-		push16 (&reg_s, reg_pc);
-		reg_pc += sign_extend (r);
-		cycles += 7;
-		break;
-	/* jsr */
-	case 0x9d:
-		ea = ea_direct ();
-		push16 (&reg_s, reg_pc);
-		reg_pc = ea;
-		cycles += 7;
-		break;
-	case 0xad:
-		ea = ea_indexed (&cycles);
-		push16 (&reg_s, reg_pc);
-		reg_pc = ea;
-		cycles += 7;
-		break;
-	case 0xbd:
-		ea = ea_extended ();
-		push16 (&reg_s, reg_pc);
-		reg_pc = ea;
-		cycles += 8;
-		break;
-	/* leax */
-	case 0x30:
-		reg_x = ea_indexed (&cycles);
-		set_cc (FLAG_Z, test_z16 (reg_x));
-		cycles += 4;
-		break;
-	/* leay */
-	case 0x31:
-		reg_y = ea_indexed (&cycles);
-		set_cc (FLAG_Z, test_z16 (reg_y));
-		cycles += 4;
-		break;
-	/* leas */
-	case 0x32:
-		reg_s = ea_indexed (&cycles);
-		cycles += 4;
-		break;
-	/* leau */
-	case 0x33:
-		reg_u = ea_indexed (&cycles);
-		cycles += 4;
-		break;
-	/* pshs */
-	case 0x34:
-		inst_psh (pc_read8 (), &reg_s, reg_u, &cycles);
-		cycles += 5;
-		break;
-	/* puls */
-	case 0x35:
-		inst_pul (pc_read8 (), &reg_s, &reg_u, &cycles);
-		cycles += 5;
-		break;
-	/* pshu */
-	case 0x36:
-		inst_psh (pc_read8 (), &reg_u, reg_s, &cycles);
-		cycles += 5;
-		break;
-	/* pulu */
-	case 0x37:
-		inst_pul (pc_read8 (), &reg_u, &reg_s, &cycles);
-		cycles += 5;
-		break;
-	/* rts */
-	case 0x39:
-		reg_pc = pull16 (&reg_s);
-		cycles += 5;
-		break;
-	/* abx */
-	case 0x3a:
-		reg_x += reg_b & 0xff;
-		cycles += 3;
-		break;
-	/* orcc */
-	case 0x1a:
-		reg_cc |= pc_read8 ();
-		cycles += 3;
-		break;
-	/* andcc */
-	case 0x1c:
-		reg_cc &= pc_read8 ();
-		cycles += 3;
-		break;
-	/* sex */
-	case 0x1d:
-		set_reg_d (sign_extend (reg_b));
-		set_cc (FLAG_N, test_n (reg_a));
-		set_cc (FLAG_Z, test_z16 (get_reg_d ()));
-		cycles += 2;
-		break;
-	/* exg */
-	case 0x1e:
-		inst_exg ();
-		cycles += 8;
-		break;
-	/* tfr */
-	case 0x1f:
-		inst_tfr ();
-		cycles += 6;
 		break;
-	/* rti */
-	case 0x3b:
-		if (get_cc (FLAG_E)) {
-			inst_pul (0xff, &reg_s, &reg_u, &cycles);
+	case 0x4: case 0x5:
+		return 0;
+	}
+
+	/* indexed */
+
+	post = read8 (c, pc);
+
+	if ((post & 0x80) == 0) {
+		return 1;
+	}
+
+	switch (post & 0x0f) {
+	case 0x8: case 0xc:
+		return 2;
+	case 0x9: case 0xd: case 0xf:
+		return 3;
+	}
+
+	return 1;
+}
+
+static void jit_emit8 (unsigned char *p, unsigned *n, unsigned b)
+{
+	p[(*n)++] = (unsigned char) b;
+}
+
+static void jit_emit32 (unsigned char *p, unsigned *n, unsigned v)
+{
+	unsigned i;
+
+	for (i = 0; i < 4; i++) {
+		jit_emit8 (p, n, (v >> (i * 8)) & 0xff);
+	}
+}
+
+static void jit_emit64 (unsigned char *p, unsigned *n, const void *v)
+{
+	unsigned long long a;
+	unsigned i;
+
+	a = (unsigned long long) (size_t) v;
+
+	for (i = 0; i < 8; i++) {
+		jit_emit8 (p, n, (unsigned) (a >> (i * 8)) & 0xff);
+	}
+}
+
+/* compiled blocks and the per pc lookup tables */
+
+struct e6809_jit {
+	unsigned blocks_used;
+	e6809_jit_block_t blocks[E6809_JIT_BLOCKS];
+	e6809_jit_block_t *map[0x10000];
+	unsigned char hits[0x10000];
+};
+
+/* drop all compiled blocks */
+
+static void jit_flush (e6809_t *c)
+{
+	if (c->jit != NULL) {
+		memset (c->jit->map, 0, sizeof (c->jit->map));
+		memset (c->jit->hits, 0, sizeof (c->jit->hits));
+		c->jit->blocks_used = 0;
+	}
+
+	c->jit_code_used = 0;
+}
+
+/* release the code buffer */
+
+static void jit_unmap (e6809_t *c)
+{
+	if (c->jit_code != NULL) {
+#ifdef _WIN32
+		VirtualFree (c->jit_code, 0, MEM_RELEASE);
+#else
+		munmap (c->jit_code, c->jit_code_size);
+#endif
+		c->jit_code = NULL;
+	}
+
+	c->jit_code_size = 0;
+	c->jit_code_used = 0;
+}
+
+/* replace the code buffer with an empty, writable one of size bytes. all
+ * compiled blocks are dropped. returns 0 if it cannot be mapped.
+ */
+
+static int jit_map (e6809_t *c, unsigned size)
+{
+	jit_unmap (c);
+	jit_flush (c);
+
+#ifdef _WIN32
+	c->jit_code = VirtualAlloc (NULL, size, MEM_COMMIT | MEM_RESERVE,
+								PAGE_READWRITE);
+#else
+	c->jit_code = mmap (NULL, size, PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (c->jit_code == MAP_FAILED) {
+		c->jit_code = NULL;
+	}
+#endif
+
+	if (c->jit_code == NULL) {
+		return 0;
+	}
+
+	c->jit_code_size = size;
+
+	return 1;
+}
+
+/* make the code buffer executable or writable, never both at once.
+ * returns 0 if the protection cannot be changed.
+ */
+
+static int jit_protect (e6809_t *c, int exec)
+{
+#ifdef _WIN32
+	DWORD old;
+
+	if (!VirtualProtect (c->jit_code, c->jit_code_size,
+						 exec ? PAGE_EXECUTE_READ : PAGE_READWRITE, &old)) {
+		return 0;
+	}
+
+	if (exec) {
+		FlushInstructionCache (GetCurrentProcess (), c->jit_code, c->jit_code_size);
+	}
+
+	return 1;
+#else
+	return mprotect (c->jit_code, c->jit_code_size,
+					 exec ? PROT_READ | PROT_EXEC : PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+static e6809_jit_block_t *jit_compile (e6809_t *c, unsigned pc)
+{
+	/* worst case code per instruction plus prologue and epilogue */
+	enum { INSN_MAX = 96, BLOCK_MAX = JIT_INSNS * INSN_MAX + 32 };
+	e6809_jit_block_t *b;
+	unsigned char *p;
+	unsigned n, i, page, op, len, start, next, exits, exit[JIT_INSNS];
+	void (*fn) (e6809_t *c, unsigned op, unsigned *cycles);
+
+	/* the buffer starts small and doubles each time it fills up, up to
+	 * JIT_CODE_MAX. after that it is emptied instead. the blocks needed
+	 * soon get compiled again.
+	 */
+
+	if (c->jit_code == NULL) {
+		if (!jit_map (c, JIT_CODE_MIN)) {
+			c->jit_failed = 1;
+			return NULL;
+		}
+	} else if (c->jit_code_used + BLOCK_MAX > c->jit_code_size) {
+		if (c->jit_code_size < JIT_CODE_MAX) {
+			if (!jit_map (c, c->jit_code_size * 2)) {
+				c->jit_failed = 1;
+				return NULL;
+			}
 		} else {
-			inst_pul (0x81, &reg_s, &reg_u, &cycles);
+			jit_flush (c);
 		}
+	}
 
-		cycles += 3;
-		break;
-	/* swi */
-	case 0x3f:
-		set_cc (FLAG_E, 1);
-		inst_psh (0xff, &reg_s, reg_u, &cycles);
-		set_cc (FLAG_I, 1);
-		set_cc (FLAG_F, 1);
-        reg_pc = read16 (0xfffa);
-        cycles += 7;
-		break;
-	/* sync */
-	case 0x13:
-		irq_status = IRQ_SYNC;
-		cycles += 2;
-		break;
-	/* daa */
-	case 0x19:
-		i0 = reg_a;
-		i1 = 0;
+	if (c->jit->blocks_used == E6809_JIT_BLOCKS) {
+		jit_flush (c);
+	}
 
-		if ((reg_a & 0x0f) > 0x09 || get_cc (FLAG_H) == 1) {
-			i1 |= 0x06;
-		}
+	if (!jit_protect (c, 0)) {
+		c->jit_failed = 1;
+		return NULL;
+	}
 
-		if ((reg_a & 0xf0) > 0x80 && (reg_a & 0x0f) > 0x09) {
-			i1 |= 0x60;
+	b = c->jit->blocks + c->jit->blocks_used++;
+	p = c->jit_code + c->jit_code_used;
+	n = 0;
+
+	b->code = (void (*) (unsigned *)) p;
+	b->max_cycles = 0;
+	b->io = 0;
+	exits = 0;
+
+	/* push rbx, keep the cycle counter pointer in rbx */
+
+	jit_emit8 (p, &n, 0x53);
+#ifdef _WIN32
+	jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0x89); jit_emit8 (p, &n, 0xcb);
+	jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0x83); jit_emit8 (p, &n, 0xec);
+	jit_emit8 (p, &n, 0x20);
+#else
+	jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0x89); jit_emit8 (p, &n, 0xfb);
+#endif
+
+	for (i = 0; i < JIT_INSNS; i++) {
+		start = pc;
+		op = read8 (c, pc);
+		page = 0;
+		len = 1;
+
+		if (op == 0x10 || op == 0x11) {
+			page = op - 0x0f;
+			op = read8 (c, pc + 1);
+			len = 2;
 		}
 
-		if ((reg_a & 0xf0) > 0x90 || get_cc (FLAG_C) == 1) {
-			i1 |= 0x60;
+		if (page == 0) {
+			fn = ops_page0[op];
+			b->max_cycles += cycles_page0[op];
+		} else if (page == 1) {
+			fn = ops_page1[op];
+			b->max_cycles += cycles_page1[op];
+		} else {
+			fn = ops_page2[op];
+			b->max_cycles += cycles_page2[op];
 		}
 
-		reg_a = i0 + i1;
+		b->max_cycles += JIT_SLACK;
 
-		set_cc (FLAG_N, test_n (reg_a));
-		set_cc (FLAG_Z, test_z8 (reg_a));
-		set_cc (FLAG_V, 0);
-		set_cc (FLAG_C, test_c (i0, i1, reg_a, 0));
-		cycles += 2;
-		break;
-	/* cwai */
-	case 0x3c:
-		reg_cc &= pc_read8 ();
-		set_cc (FLAG_E, 1);
-		inst_psh (0xff, &reg_s, reg_u, &cycles);
-		irq_status = IRQ_CWAI;
-		cycles += 4;
-		break;
+		/* mov eax, [rbx] ; mov r11, &jit_start ; mov [r11], eax */
 
-	/* page 1 instructions */
+		jit_emit8 (p, &n, 0x8b); jit_emit8 (p, &n, 0x03);
+		jit_emit8 (p, &n, 0x49); jit_emit8 (p, &n, 0xbb);
+		jit_emit64 (p, &n, &c->jit_start);
+		jit_emit8 (p, &n, 0x41); jit_emit8 (p, &n, 0x89); jit_emit8 (p, &n, 0x03);
 
-	case 0x10:
-		op = pc_read8 ();
+		/* mov r11, &reg_pc ; mov dword [r11], pc + len */
 
-		switch (op) {
-		/* lbra */
-		case 0x20:
-		/* lbrn */
-		case 0x21:
-			inst_bra16 (0, op, &cycles);
-			break;
-		/* lbhi */
-		case 0x22:
-		/* lbls */
-		case 0x23:
-			inst_bra16 (get_cc (FLAG_C) | get_cc (FLAG_Z), op, &cycles);
-			break;
-		/* lbhs/lbcc */
-		case 0x24:
-		/* lblo/lbcs */
-		case 0x25:
-			inst_bra16 (get_cc (FLAG_C), op, &cycles);
-			break;
-		/* lbne */
-		case 0x26:
-		/* lbeq */
-		case 0x27:
-			inst_bra16 (get_cc (FLAG_Z), op, &cycles);
-			break;
-		/* lbvc */
-		case 0x28:
-		/* lbvs */
-		case 0x29:
-			inst_bra16 (get_cc (FLAG_V), op, &cycles);
-			break;
-		/* lbpl */
-		case 0x2a:
-		/* lbmi */
-		case 0x2b:
-			inst_bra16 (get_cc (FLAG_N), op, &cycles);
-			break;
-		/* lbge */
-		case 0x2c:
-		/* lblt */
-		case 0x2d:
-			inst_bra16 (get_cc (FLAG_N) ^ get_cc (FLAG_V), op, &cycles);
-			break;
-		/* lbgt */
-		case 0x2e:
-		/* lble */
-		case 0x2f:
-			inst_bra16 (get_cc (FLAG_Z) |
-						(get_cc (FLAG_N) ^ get_cc (FLAG_V)), op, &cycles);
-			break;
-		/* cmpd */
-		case 0x83:
-			inst_sub16 (get_reg_d (), pc_read16 ());
-			cycles += 5;
-			break;
-		case 0x93:
-			ea = ea_direct ();
-			inst_sub16 (get_reg_d (), read16 (ea));
-			cycles += 7;
-			break;
-		case 0xa3:
-			ea = ea_indexed (&cycles);
-			inst_sub16 (get_reg_d (), read16 (ea));
-			cycles += 7;
-			break;
-		case 0xb3:
-			ea = ea_extended ();
-			inst_sub16 (get_reg_d (), read16 (ea));
-			cycles += 8;
-			break;
-		/* cmpy */
-		case 0x8c:
-			inst_sub16 (reg_y, pc_read16 ());
-			cycles += 5;
-			break;
-		case 0x9c:
-			ea = ea_direct ();
-			inst_sub16 (reg_y, read16 (ea));
-			cycles += 7;
-			break;
-		case 0xac:
-			ea = ea_indexed (&cycles);
-			inst_sub16 (reg_y, read16 (ea));
-			cycles += 7;
-			break;
-		case 0xbc:
-			ea = ea_extended ();
-			inst_sub16 (reg_y, read16 (ea));
-			cycles += 8;
-			break;
-		/* ldy */
-		case 0x8e:
-			reg_y = pc_read16 ();
-			inst_tst16 (reg_y);
-			cycles += 4;
-			break;
-		case 0x9e: 
-			ea = ea_direct ();
-			reg_y = read16 (ea);
-			inst_tst16 (reg_y);
-			cycles += 6;
-			break;
-		case 0xae:
-			ea = ea_indexed (&cycles);
-			reg_y = read16 (ea);
-			inst_tst16 (reg_y);
-			cycles += 6;
-			break;
-		case 0xbe:
-			ea = ea_extended ();
-			reg_y = read16 (ea);
-			inst_tst16 (reg_y);
-			cycles += 7;
-			break;
-		/* sty */
-		case 0x9f:
-			ea = ea_direct ();
-			write16 (ea, reg_y);
-			inst_tst16 (reg_y);
-			cycles += 6;
-			break;
-		case 0xaf:
-			ea = ea_indexed (&cycles);
-			write16 (ea, reg_y);
-			inst_tst16 (reg_y);
-			cycles += 6;
-			break;
-		case 0xbf:
-			ea = ea_extended ();
-			write16 (ea, reg_y);
-			inst_tst16 (reg_y);
-			cycles += 7;
-			break;
-		/* lds */
-		case 0xce:
-			reg_s = pc_read16 ();
-			inst_tst16 (reg_s);
-			cycles += 4;
-			break;
-		case 0xde: 
-			ea = ea_direct ();
-			reg_s = read16 (ea);
-			inst_tst16 (reg_s);
-			cycles += 6;
-			break;
-		case 0xee:
-			ea = ea_indexed (&cycles);
-			reg_s = read16 (ea);
-			inst_tst16 (reg_s);
-			cycles += 6;
-			break;
-		case 0xfe:
-			ea = ea_extended ();
-			reg_s = read16 (ea);
-			inst_tst16 (reg_s);
-			cycles += 7;
-			break;
-		/* sts */
-		case 0xdf:
-			ea = ea_direct ();
-			write16 (ea, reg_s);
-			inst_tst16 (reg_s);
-			cycles += 6;
-			break;
-		case 0xef:
-			ea = ea_indexed (&cycles);
-			write16 (ea, reg_s);
-			inst_tst16 (reg_s);
-			cycles += 6;
-			break;
-		case 0xff:
-			ea = ea_extended ();
-			write16 (ea, reg_s);
-			inst_tst16 (reg_s);
-			cycles += 7;
-			break;
-		/* swi2 */
-		case 0x3f:
-			set_cc (FLAG_E, 1);
-			inst_psh (0xff, &reg_s, reg_u, &cycles);
-		    reg_pc = read16 (0xfff4);
-			cycles += 8;
-			break;
-		default:
-			printf ("unknown page-1 op code: %.2x\n", op);
+		jit_emit8 (p, &n, 0x49); jit_emit8 (p, &n, 0xbb);
+		jit_emit64 (p, &n, &c->reg_pc);
+		jit_emit8 (p, &n, 0x41); jit_emit8 (p, &n, 0xc7); jit_emit8 (p, &n, 0x03);
+		jit_emit32 (p, &n, (pc + len) & 0xffff);
+
+		/* add dword [rbx], cycles */
+
+		jit_emit8 (p, &n, 0x83); jit_emit8 (p, &n, 0x03);
+		jit_emit8 (p, &n, page == 0 ? cycles_page0[op] :
+					  page == 1 ? cycles_page1[op] : cycles_page2[op]);
+
+		/* handler (c, op, cycles). each cpu has code of its own, so c is a
+		 * constant here.
+		 */
+
+#ifdef _WIN32
+		jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0xb9); jit_emit64 (p, &n, c);
+		jit_emit8 (p, &n, 0xba); jit_emit32 (p, &n, op);
+		jit_emit8 (p, &n, 0x49); jit_emit8 (p, &n, 0x89); jit_emit8 (p, &n, 0xd8);
+#else
+		jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0xbf); jit_emit64 (p, &n, c);
+		jit_emit8 (p, &n, 0xbe); jit_emit32 (p, &n, op);
+		jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0x89); jit_emit8 (p, &n, 0xda);
+#endif
+		jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0xb8);
+		jit_emit64 (p, &n, (const void *) (size_t) fn);
+		jit_emit8 (p, &n, 0xff); jit_emit8 (p, &n, 0xd0);
+
+		if (jit_ends (page, op)) {
 			break;
 		}
 
-		break;
+		/* the handler leaves reg_pc past the operands. anything else
+		 * means it changed the flow of control after all, so leave.
+		 *
+		 * mov r11, &reg_pc ; cmp dword [r11], next ; jne epilogue
+		 */
 
-	/* page 2 instructions */
+		next = ((pc + len) & 0xffff) + jit_operands (c, page, op, pc + len);
 
-	case 0x11:
-		op = pc_read8 ();
+		jit_emit8 (p, &n, 0x49); jit_emit8 (p, &n, 0xbb);
+		jit_emit64 (p, &n, &c->reg_pc);
+		jit_emit8 (p, &n, 0x41); jit_emit8 (p, &n, 0x81); jit_emit8 (p, &n, 0x3b);
+		jit_emit32 (p, &n, next);
+		jit_emit8 (p, &n, 0x0f); jit_emit8 (p, &n, 0x85);
+		exit[exits++] = n;
+		jit_emit32 (p, &n, 0);
 
-		switch (op) {
-		/* cmpu */
-		case 0x83:
-			inst_sub16 (reg_u, pc_read16 ());
-			cycles += 5;
-			break;
-		case 0x93:
-			ea = ea_direct ();
-			inst_sub16 (reg_u, read16 (ea));
-			cycles += 7;
-			break;
-		case 0xa3:
-			ea = ea_indexed (&cycles);
-			inst_sub16 (reg_u, read16 (ea));
-			cycles += 7;
-			break;
-		case 0xb3:
-			ea = ea_extended ();
-			inst_sub16 (reg_u, read16 (ea));
-			cycles += 8;
-			break;
-		/* cmps */
-		case 0x8c:
-			inst_sub16 (reg_s, pc_read16 ());
-			cycles += 5;
+		pc = next & 0xffff;
+
+		/* e6809_run has to see the cpu arrive at marked pcs, to run the
+		 * routine there through hle or look for an idle loop.
+		 */
+
+		if (!c->dcache_page[pc >> 8] || pc < start || pc_flags (c, pc) != 0) {
 			break;
-		case 0x9c:
-			ea = ea_direct ();
-			inst_sub16 (reg_s, read16 (ea));
+		}
+	}
+
+	/* epilogue, with the exits pointed at it */
+
+	for (i = 0; i < exits; i++) {
+		len = exit[i];
+		jit_emit32 (p, &len, n - (exit[i] + 4));
+	}
+
+#ifdef _WIN32
+	jit_emit8 (p, &n, 0x48); jit_emit8 (p, &n, 0x83); jit_emit8 (p, &n, 0xc4);
+	jit_emit8 (p, &n, 0x20);
+#endif
+	jit_emit8 (p, &n, 0x5b);
+	jit_emit8 (p, &n, 0xc3);
+
+	c->jit_code_used += (n + 15) & ~15;
+
+	if (!jit_protect (c, 1)) {
+		c->jit_failed = 1;
+		return NULL;
+	}
+
+	return b;
+}
+
+/* run the compiled block at reg_pc if there is a usable one */
+
+static einline unsigned jit_exec (e6809_t *c, unsigned *cycles)
+{
+	e6809_jit_block_t *b;
+	unsigned pc;
+
+	if (c->jit_failed || get_cc (c, FLAG_I) == 0 || get_cc (c, FLAG_F) == 0) {
+		return 0;
+	}
+
+	if (c->jit == NULL) {
+		c->jit = calloc (1, sizeof (*c->jit));
+
+		if (c->jit == NULL) {
+			c->jit_failed = 1;
+			return 0;
+		}
+	}
+
+	pc = c->reg_pc & 0xffff;
+	b = c->jit->map[pc];
+
+	if (b == NULL) {
+		if (++c->jit->hits[pc] < JIT_HOT) {
+			return 0;
+		}
+
+		b = jit_compile (c, pc);
+
+		if (b == NULL) {
+			return 0;
+		}
+
+		c->jit->map[pc] = b;
+	}
+
+	if (b->io || *cycles + b->max_cycles > c->jit_limit) {
+		return 0;
+	}
+
+	c->jit_io = 0;
+	c->jit_running = 1;
+	(*b->code) (cycles);
+	c->jit_running = 0;
+
+	if (c->jit_io) {
+		b->io = 1;
+	}
+
+	return 1;
+}
+
+#endif
+
+void e6809_reset (e6809_t *c)
+{
+	c->cycles = 0;
+	c->idle_pc = IDLE_NONE;
+
+	c->pc_marks = 0;
+	memset (c->pc_page, 0, sizeof (c->pc_page));
+
+	dcache_reset (c);
+#ifdef E6809_JIT
+	jit_flush (c);
+#endif
+
+	c->reg_x = 0;
+	c->reg_y = 0;
+	c->reg_u = 0;
+	c->reg_s = 0;
+
+	c->reg_a = 0;
+	c->reg_b = 0;
+
+	c->reg_dp = 0;
+
+	set_reg_cc (c, FLAG_I | FLAG_F);
+	c->irq_status = IRQ_NORMAL;
+
+	c->reg_pc = read16 (c, 0xfffe);
+}
+
+/* release what the cpu allocated for itself */
+
+void e6809_done (e6809_t *c)
+{
+	dcache_free (c);
+
+#ifdef E6809_JIT
+	jit_unmap (c);
+
+	free (c->jit);
+	c->jit = NULL;
+#endif
+}
+
+/* execute a single instruction (or compiled block) or handle interrupts and
+ * return the cycles used.
+ */
+
+static unsigned cpu_step (e6809_t *c, unsigned irq_i, unsigned irq_f)
+{
+	unsigned cycles = 0;
+
+	if (irq_f) {
+		if (get_cc (c, FLAG_F) == 0) {
+			if (c->irq_status != IRQ_CWAI) {
+				set_cc (c, FLAG_E, 0);
+				inst_psh (c, 0x81, &c->reg_s, c->reg_u, &cycles);
+			}
+
+			set_cc (c, FLAG_I, 1);
+			set_cc (c, FLAG_F, 1);
+
+			c->reg_pc = read16 (c, 0xfff6);
+			c->irq_status = IRQ_NORMAL;
 			cycles += 7;
-			break;
-		case 0xac:
-			ea = ea_indexed (&cycles);
-			inst_sub16 (reg_s, read16 (ea));
+		} else {
+			if (c->irq_status == IRQ_SYNC) {
+				c->irq_status = IRQ_NORMAL;
+			}
+		}
+	}
+	
+	if (irq_i) {
+		if (get_cc (c, FLAG_I) == 0) {
+			if (c->irq_status != IRQ_CWAI) {
+				set_cc (c, FLAG_E, 1);
+				inst_psh (c, 0xff, &c->reg_s, c->reg_u, &cycles);
+			}
+
+			set_cc (c, FLAG_I, 1);
+
+			c->reg_pc = read16 (c, 0xfff8);
+			c->irq_status = IRQ_NORMAL;
 			cycles += 7;
-			break;
-		case 0xbc:
-			ea = ea_extended ();
-			inst_sub16 (reg_s, read16 (ea));
-			cycles += 8;
-			break;
-		/* swi3 */
-		case 0x3f:
-			set_cc (FLAG_E, 1);
-			inst_psh (0xff, &reg_s, reg_u, &cycles);
-		    reg_pc = read16 (0xfff2);
-			cycles += 8;
-			break;
-		default:
-			printf ("unknown page-2 op code: %.2x\n", op);
-			break;
+		} else {
+			if (c->irq_status == IRQ_SYNC) {
+				c->irq_status = IRQ_NORMAL;
+			}
 		}
+	}
 
-		break;
+	if (c->irq_status != IRQ_NORMAL) {
+		return cycles + 1;
+	}
 
-	default:
-		printf ("unknown page-0 op code: %.2x\n", op);
-		break;
+	if (c->dcache_page[(c->reg_pc >> 8) & 0xff]) {
+#ifdef E6809_JIT
+		if (c->jit_enable && jit_exec (c, &cycles)) {
+			return cycles;
+		}
+#endif
+
+		dcache_exec (c, &cycles);
+	} else {
+		dispatch_page0 (c, pc_read8 (c), &cycles);
 	}
 
 	return cycles;
 }
 
+/* execute a single instruction or handle interrupts and return */
+
+unsigned e6809_sstep (e6809_t *c, unsigned irq_i, unsigned irq_f)
+{
+	unsigned cycles;
+
+	c->idle_pc = IDLE_NONE;
+
+	cycles = cpu_step (c, irq_i, irq_f);
+	c->cycles += cycles;
+
+	return cycles;
+}
+
+/* add flags to a pc, keeping the marks in order. pcs past the first
+ * E6809_PC_MARKS are ignored.
+ */
+
+static void pc_mark (e6809_t *c, unsigned pc, unsigned flags)
+{
+	unsigned m, n;
+
+	pc &= 0xffff;
+
+	for (m = 0; m < c->pc_marks && c->pc_mark[m] < pc; m++) {
+	}
+
+	if (m == c->pc_marks || c->pc_mark[m] != pc) {
+		if (c->pc_marks == E6809_PC_MARKS) {
+			return;
+		}
+
+		for (n = c->pc_marks; n > m; n--) {
+			c->pc_mark[n] = c->pc_mark[n - 1];
+			c->pc_mark_flags[n] = c->pc_mark_flags[n - 1];
+		}
+
+		c->pc_mark[m] = pc;
+		c->pc_mark_flags[m] = 0;
+		c->pc_marks++;
+	}
+
+	c->pc_mark_flags[m] |= flags;
+	c->pc_page[pc >> 8] |= flags;
+}
+
+/* mark the entry of a routine the host may emulate through hle */
+
+void e6809_hle_pc (e6809_t *c, unsigned pc)
+{
+	pc_mark (c, pc, PC_HLE);
+}
+
+void e6809_get_regs (e6809_t *c, e6809_regs_t *regs)
+{
+	regs->a = c->reg_a & 0xff;
+	regs->b = c->reg_b & 0xff;
+	regs->x = c->reg_x & 0xffff;
+	regs->y = c->reg_y & 0xffff;
+	regs->u = c->reg_u & 0xffff;
+	regs->s = c->reg_s & 0xffff;
+	regs->dp = c->reg_dp & 0xff;
+	regs->cc = get_reg_cc (c);
+	regs->pc = c->reg_pc & 0xffff;
+}
+
+void e6809_set_regs (e6809_t *c, const e6809_regs_t *regs)
+{
+	c->reg_a = regs->a & 0xff;
+	c->reg_b = regs->b & 0xff;
+	c->reg_x = regs->x & 0xffff;
+	c->reg_y = regs->y & 0xffff;
+	c->reg_u = regs->u & 0xffff;
+	c->reg_s = regs->s & 0xffff;
+	c->reg_dp = regs->dp & 0xff;
+	set_reg_cc (c, regs->cc & 0xff);
+	c->reg_pc = regs->pc & 0xffff;
+}
+
+/* mark the start of a loop the cpu is known to idle in, however long */
+
+void e6809_idle_pc (e6809_t *c, unsigned pc)
+{
+	pc_mark (c, pc, PC_IDLE);
+}
+
+/* called after a step that jumped back to reg_pc. if the cpu is in the state
+ * it was in when it was last here, with no writes since, the loop repeats
+ * exactly every 'period' cycles until the data its reads return changes.
+ * skip as many whole periods as fit in both the window the host gives for
+ * that and 'limit', and return the cycles skipped. either way, start
+ * watching the loop from here.
+ */
+
+static unsigned idle_loop (e6809_t *c, unsigned used, unsigned limit)
+{
+	unsigned regs[IDLE_REGS];
+	unsigned period, window, skip;
+
+	regs[0] = c->reg_pc;
+	regs[1] = c->reg_a;
+	regs[2] = c->reg_b;
+	regs[3] = c->reg_x;
+	regs[4] = c->reg_y;
+	regs[5] = c->reg_u;
+	regs[6] = c->reg_s;
+	regs[7] = c->reg_dp;
+	regs[8] = get_reg_cc (c);
+	regs[9] = c->irq_status;
+
+	skip = 0;
+
+	if (c->idle != NULL && !c->idle_dirty && c->idle_pc == c->reg_pc &&
+		memcmp (regs, c->idle_regs, sizeof (regs)) == 0) {
+		period = (unsigned) (c->cycles - c->idle_start);
+		window = (*c->idle) (c->user, used, c->idle_naddr, c->idle_addr, c->idle_data);
+
+		if (window > limit) {
+			window = limit;
+		}
+
+		skip = window - window % period;
+		c->cycles += skip;
+	}
+
+	memcpy (c->idle_regs, regs, sizeof (regs));
+	c->idle_pc = c->reg_pc;
+	c->idle_start = c->cycles;
+	c->idle_dirty = 0;
+	c->idle_naddr = 0;
+
+	return skip;
+}
+
+/* execute instructions until budget cycles have been used or c->cycles
+ * reaches next_event, whichever comes first, and return the cycles used.
+ * at least one instruction is always executed. the interrupt lines are
+ * sampled before every instruction.
+ *
+ * the host's peripherals may lag behind the cpu while it runs. before an
+ * access to a trapped page sync is called to catch them up, and the
+ * run ends after that instruction since the access may have changed when
+ * the next event is due. the interrupt lines must not change before
+ * next_event unless the cpu accesses a trapped page.
+ */
+
+unsigned e6809_run (e6809_t *c, unsigned budget, unsigned long next_event)
+{
+	unsigned long start;
+	unsigned used, wait, pc, n;
+
+	start = c->cycles;
+	used = 0;
+
+	c->run_active = 1;
+	c->run_io = 0;
+
+	do {
+		if (c->irq_status != IRQ_NORMAL && c->irq == 0 && c->firq == 0) {
+			/* waiting in cwai or sync with both interrupt lines low. each
+			 * step would just burn a cycle, and the lines cannot change
+			 * before next_event, so jump straight there.
+			 */
+
+			wait = (unsigned) (next_event - c->cycles);
+
+			if (wait > budget - used) {
+				wait = budget - used;
+			}
+
+			c->cycles += (wait > 0) ? wait : 1;
+		} else if (c->hle != NULL && (pc_flags (c, c->reg_pc) & PC_HLE) &&
+				   c->irq_status == IRQ_NORMAL && (n = (*c->hle) (c->user, used)) != 0) {
+			/* the host ran the routine itself, bringing its peripherals
+			 * along, so whatever next_event was is stale.
+			 */
+
+			c->cycles += n;
+			c->run_io = 1;
+			c->idle_pc = IDLE_NONE;
+		} else {
+			c->run_base = used;
+			c->jit_limit = budget > used ? budget - used : 0;
+			pc = c->reg_pc;
+
+			c->cycles += cpu_step (c, c->irq, c->firq);
+
+			if (((pc - c->reg_pc) & 0xffff) <= IDLE_SPAN || (pc_flags (c, c->reg_pc) & PC_IDLE)) {
+				/* jumped back, maybe to the top of an idle loop. it may
+				 * skip ahead as far as the end of the budget or next_event.
+				 */
+
+				used = (unsigned) (c->cycles - start);
+				wait = budget > used ? budget - used : 0;
+
+				if ((long) (next_event - c->cycles) < (long) wait) {
+					wait = (long) (next_event - c->cycles) > 0 ?
+						(unsigned) (next_event - c->cycles) : 0;
+				}
+
+				idle_loop (c, used, wait);
+			}
+		}
+
+		used = (unsigned) (c->cycles - start);
+	} while (!c->run_io && used < budget && (long) (next_event - c->cycles) > 0);
+
+	c->run_active = 0;
+	c->jit_limit = 0;
+
+	return used;
+}
+
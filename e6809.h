@@ -1,13 +1,205 @@
 #ifndef __E6809_H
 #define __E6809_H
 
-/* user defined read and write functions */
+/* cpu registers, for hosts that emulate rom routines at a high level */
 
-extern unsigned char (*e6809_read8) (unsigned address);
-extern void (*e6809_write8) (unsigned address, unsigned char data);
+typedef struct e6809_regs {
+	unsigned a, b;
+	unsigned x, y, u, s;
+	unsigned dp, cc, pc;
+} e6809_regs_t;
 
-void e6809_reset (void);
-unsigned e6809_sstep (unsigned irq_i, unsigned irq_f);
+typedef struct e6809 e6809_t;
 
-#endif
+/* internals of e6809_t, only used by e6809.c */
+
+enum {
+	E6809_IDLE_READS	= 4,
+	E6809_IDLE_REGS		= 10,
+	E6809_PC_MARKS		= 32,
+	E6809_JIT_BLOCKS	= 32768
+};
+
+typedef struct e6809_dcache {
+	void (*fn) (e6809_t *c, unsigned op, unsigned *cycles);
+	unsigned char op;
+	unsigned char cycles;
+	unsigned char len;
+} e6809_dcache_t;
+
+typedef struct e6809_jit_block {
+	void (*code) (unsigned *cycles);
+	unsigned max_cycles;
+	unsigned io;
+} e6809_jit_block_t;
+
+/* the complete state of one cpu. any number of them may run side by side,
+ * each on one thread at a time. the host zeroes it, fills in the fields
+ * below and calls e6809_reset before anything else, and calls e6809_done
+ * once it is finished with it. compiled blocks refer to the cpu by address,
+ * so it must not be moved or copied after e6809_reset. e6809_reset forgets
+ * the pcs given to e6809_idle_pc and e6809_hle_pc, so they are given again
+ * after each reset.
+ */
+
+struct e6809 {
+	/* registers. a 16-bit register has valid bits only in the lower 16
+	 * bits and an 8-bit register only in the lower 8 bits.
+	 */
+
+	unsigned reg_x, reg_y;	/* index registers */
+	unsigned reg_u;			/* user stack pointer */
+	unsigned reg_s;			/* hardware stack pointer */
+	unsigned reg_pc;		/* program counter */
+	unsigned reg_a, reg_b;	/* accumulators */
+	unsigned reg_dp;		/* direct page register */
+	unsigned reg_cc;		/* condition codes */
+
+	/* lazily evaluated condition codes. alu instructions record their
+	 * inputs and result instead of computing the flags. the flags in
+	 * cc_lazy are only derived from that record when something reads
+	 * them, the other flags are in reg_cc.
+	 */
+
+	unsigned cc_lazy;
+	unsigned cc_kind;
+	unsigned cc_i0;
+	unsigned cc_i1;
+	unsigned cc_r;
+
+	/* flag to see if interrupts should be handled (sync/cwai). */
+
+	unsigned irq_status;
+
+	/* user defined read and write functions, passed user */
+
+	unsigned char (*read8) (void *user, unsigned address);
+	void (*write8) (void *user, unsigned address, unsigned char data);
+	void *user;
+
+	/* interrupt request lines used by e6809_run, driven by the host */
+
+	unsigned irq;
+	unsigned firq;
+
+	/* cycles executed since reset */
+
+	unsigned long cycles;
+
+	/* memory map. each entry points at the host memory backing a 256 byte
+	 * page of the address space and is accessed directly. pages with a
+	 * NULL entry go through read8 and write8 instead.
+	 */
+
+	const unsigned char *rmap[256];
+	unsigned char *wmap[256];
+
+	/* called inside e6809_run before an access to a page that traps to
+	 * read8/write8, with the cycles the call used up to the start of the
+	 * current instruction.
+	 */
+
+	void (*sync) (void *user, unsigned cycles);
+
+	/* called inside e6809_run when the cpu is found going round a loop
+	 * that writes nothing and whose only reads of trapped pages are the n
+	 * addresses in addr, which returned the bytes in data. cycles is as for
+	 * sync. the host returns how many cycles from there on those reads are
+	 * sure to keep returning the same data (0 if it cannot tell), and the
+	 * cpu skips the whole passes round the loop that fit. loops are looked
+	 * for after short backward jumps and at pcs given to e6809_idle_pc.
+	 */
 
+	unsigned (*idle) (void *user, unsigned cycles, unsigned n,
+					  const unsigned *addr, const unsigned char *data);
+
+	/* called inside e6809_run in place of the instruction at a pc given to
+	 * e6809_hle_pc, with cycles as for sync. the host may run the whole
+	 * routine there itself, peripherals included, through e6809_get_regs
+	 * and e6809_set_regs. it returns the cycles that took, or 0 to have the
+	 * cpu execute the routine after all.
+	 */
+
+	unsigned (*hle) (void *user, unsigned cycles);
+
+	/* block compiler (x86-64 only, ignored elsewhere). compiled blocks only
+	 * run from e6809_run and never past its budget.
+	 */
+
+	int jit_enable;
+
+	/* everything from here on is private to e6809.c */
+
+	/* state of the e6809_run call in progress. run_active is set while it
+	 * runs, run_base holds the cycles it used before the current step and
+	 * run_io records that the current step accessed a trapped page.
+	 */
+
+	unsigned run_active;
+	unsigned run_base;
+	unsigned run_io;
+
+	/* set while a compiled block runs. jit_limit is the number of cycles
+	 * the current instruction or block may use, jit_start those used by
+	 * the block up to the start of the current instruction. jit_io records
+	 * that the block accessed a trapped page.
+	 */
+
+	unsigned jit_running;
+	unsigned jit_limit;
+	unsigned jit_start;
+	unsigned jit_io;
+
+	/* idle loop detection */
+
+	unsigned idle_pc;
+	unsigned idle_regs[E6809_IDLE_REGS];
+	unsigned long idle_start;
+	unsigned idle_dirty;
+	unsigned idle_naddr;
+	unsigned idle_addr[E6809_IDLE_READS];
+	unsigned char idle_data[E6809_IDLE_READS];
+
+	/* pages whose contents cannot change while the cpu runs */
+
+	unsigned char dcache_page[256];
+
+	/* pcs the host has told us about, in ascending order, with their
+	 * flags. pc_page holds the flags of all marks in each page, so only
+	 * pcs in a marked page are looked up.
+	 */
+
+	unsigned pc_marks;
+	unsigned pc_mark[E6809_PC_MARKS];
+	unsigned char pc_mark_flags[E6809_PC_MARKS];
+	unsigned char pc_page[256];
+
+	/* decoded instruction cache, by page. only pages in dcache_page ever
+	 * get one, allocated the first time code in them runs.
+	 */
+
+	e6809_dcache_t *dcache[256];
+
+	/* block compiler. the block tables are allocated the first time a
+	 * block is looked up with jit_enable set. the code buffer is mapped
+	 * when the first block is compiled, doubles in size when it fills up
+	 * and is only writable, never executable, while a block is compiled.
+	 */
+
+	unsigned char *jit_code;
+	unsigned jit_code_size;
+	unsigned jit_code_used;
+	unsigned jit_failed;
+	struct e6809_jit *jit;
+};
+
+void e6809_reset (e6809_t *c);
+void e6809_done (e6809_t *c);
+unsigned e6809_sstep (e6809_t *c, unsigned irq_i, unsigned irq_f);
+unsigned e6809_run (e6809_t *c, unsigned budget, unsigned long next_event);
+void e6809_idle_pc (e6809_t *c, unsigned pc);
+void e6809_hle_pc (e6809_t *c, unsigned pc);
+void e6809_get_regs (e6809_t *c, e6809_regs_t *regs);
+void e6809_set_regs (e6809_t *c, const e6809_regs_t *regs);
+
+#endif
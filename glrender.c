@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include "vecx.h"
+#include "glrender.h"
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+/* from opengl 1.5, which not every gl.h covers */
+
+#define GLR_ARRAY_BUFFER	0x8892
+#define GLR_DYNAMIC_DRAW	0x88e8
+
+enum {
+	/* end points are stored relative to the middle of the screen, which
+	 * puts them within 16 bits.
+	 */
+
+	GLR_CENTER_X	= ALG_MAX_X / 2,
+	GLR_CENTER_Y	= ALG_MAX_Y / 2,
+
+	GLR_PARKED		= -32768	/* where parked slots go, off screen */
+};
+
+/* one end point of a vector, two per slot */
+
+typedef struct glrender_vertex {
+	GLshort x, y;
+	GLubyte color[4];
+} glrender_vertex_t;
+
+typedef void (APIENTRY *glr_genbuffers_fn) (GLsizei n, GLuint *buffers);
+typedef void (APIENTRY *glr_deletebuffers_fn) (GLsizei n, const GLuint *buffers);
+typedef void (APIENTRY *glr_bindbuffer_fn) (GLenum target, GLuint buffer);
+typedef void (APIENTRY *glr_bufferdata_fn) (GLenum target, ptrdiff_t size,
+											const void *data, GLenum usage);
+typedef void (APIENTRY *glr_buffersubdata_fn) (GLenum target, ptrdiff_t offset,
+											   ptrdiff_t size, const void *data);
+
+static glr_genbuffers_fn glr_genbuffers;
+static glr_deletebuffers_fn glr_deletebuffers;
+static glr_bindbuffer_fn glr_bindbuffer;
+static glr_bufferdata_fn glr_bufferdata;
+static glr_buffersubdata_fn glr_buffersubdata;
+
+static GLuint vbo;					/* 0 when drawing from memory */
+static long vbo_cap;				/* slots the buffer object has room for */
+
+static glrender_vertex_t *verts;	/* mirror of the slots */
+static long verts_cap;
+static long slots;					/* slots in use */
+
+static void *glr_proc (glrender_getproc_fn getproc, const char *name,
+					   const char *suffix)
+{
+	char buf[64];
+
+	sprintf (buf, "%s%s", name, suffix);
+
+	return getproc (buf);
+}
+
+/* call with the context current. returns 1 if vertex buffer objects are
+ * used, 0 if vectors are drawn from memory.
+ */
+
+int glrender_init (glrender_getproc_fn getproc)
+{
+	const char *version, *ext, *suffix;
+	int major, minor;
+
+	version = (const char *) glGetString (GL_VERSION);
+	ext = (const char *) glGetString (GL_EXTENSIONS);
+	suffix = NULL;
+
+	if (version != NULL && sscanf (version, "%d.%d", &major, &minor) == 2 &&
+		(major > 1 || minor >= 5)) {
+		suffix = "";
+	} else if (ext != NULL && strstr (ext, "GL_ARB_vertex_buffer_object") != NULL) {
+		suffix = "ARB";
+	}
+
+	vbo = 0;
+	vbo_cap = 0;
+
+	if (suffix != NULL && getproc != NULL) {
+		glr_genbuffers = (glr_genbuffers_fn) glr_proc (getproc, "glGenBuffers", suffix);
+		glr_deletebuffers = (glr_deletebuffers_fn) glr_proc (getproc, "glDeleteBuffers", suffix);
+		glr_bindbuffer = (glr_bindbuffer_fn) glr_proc (getproc, "glBindBuffer", suffix);
+		glr_bufferdata = (glr_bufferdata_fn) glr_proc (getproc, "glBufferData", suffix);
+		glr_buffersubdata = (glr_buffersubdata_fn) glr_proc (getproc, "glBufferSubData", suffix);
+
+		if (glr_genbuffers != NULL && glr_deletebuffers != NULL &&
+			glr_bindbuffer != NULL && glr_bufferdata != NULL &&
+			glr_buffersubdata != NULL) {
+			glr_genbuffers (1, &vbo);
+		}
+	}
+
+	/* a new context has none of the slots yet */
+
+	slots = 0;
+	verts_cap = 0;
+	free (verts);
+	verts = NULL;
+
+	return vbo != 0;
+}
+
+void glrender_done (void)
+{
+	if (vbo != 0) {
+		glr_deletebuffers (1, &vbo);
+		vbo = 0;
+	}
+
+	vbo_cap = 0;
+
+	free (verts);
+	verts = NULL;
+	verts_cap = 0;
+	slots = 0;
+}
+
+/* take in the slots of the live set that changed. color_set holds the
+ * intensity of each vectrex color in [0, 1], NULL for a linear ramp from
+ * black.
+ */
+
+void glrender_update (vecx_live_t *live, const float *color_set)
+{
+	glrender_vertex_t *v;
+	long s, lo, hi;
+	GLubyte c;
+
+	lo = live->dirty_lo;
+	hi = live->dirty_hi;
+
+	if (live->cap > verts_cap) {
+		v = realloc (verts, (size_t) live->cap * 2 * sizeof (*v));
+
+		if (v == NULL) {
+			/* keep drawing what we have, the changes stay dirty */
+
+			return;
+		}
+
+		verts = v;
+		verts_cap = live->cap;
+
+		lo = 0;
+		hi = live->cnt;
+	}
+
+	for (s = lo; s < hi; s++) {
+		v = verts + s * 2;
+
+		if (live->x0[s] == VECTOR_PARKED) {
+			v[0].x = GLR_PARKED;
+			v[0].y = GLR_PARKED;
+			v[1].x = GLR_PARKED;
+			v[1].y = GLR_PARKED;
+		} else {
+			v[0].x = (GLshort) (live->x0[s] - GLR_CENTER_X);
+			v[0].y = (GLshort) (live->y0[s] - GLR_CENTER_Y);
+			v[1].x = (GLshort) (live->x1[s] - GLR_CENTER_X);
+			v[1].y = (GLshort) (live->y1[s] - GLR_CENTER_Y);
+		}
+
+		if (color_set != NULL) {
+			c = (GLubyte) (color_set[live->color[s]] * 255.0f);
+		} else {
+			c = (GLubyte) (live->color[s] * 255 / (VECTREX_COLORS - 1));
+		}
+
+		v[0].color[0] = c;
+		v[0].color[1] = c;
+		v[0].color[2] = c;
+		v[0].color[3] = 191;	/* 0.75 alpha for lines */
+		memcpy (v[1].color, v[0].color, sizeof (v[1].color));
+	}
+
+	slots = live->cnt;
+
+	if (vbo != 0) {
+		glr_bindbuffer (GLR_ARRAY_BUFFER, vbo);
+
+		if (vbo_cap < verts_cap) {
+			/* grown, upload every slot */
+
+			glr_bufferdata (GLR_ARRAY_BUFFER, verts_cap * 2 * sizeof (*verts),
+							NULL, GLR_DYNAMIC_DRAW);
+			vbo_cap = verts_cap;
+
+			lo = 0;
+			hi = slots;
+		}
+
+		if (hi > lo) {
+			glr_buffersubdata (GLR_ARRAY_BUFFER, lo * 2 * sizeof (*verts),
+							   (hi - lo) * 2 * sizeof (*verts), verts + lo * 2);
+		}
+
+		glr_bindbuffer (GLR_ARRAY_BUFFER, 0);
+	}
+
+	vecx_live_clean (live);
+}
+
+/* start a frame of width x height pixels on a black screen */
+
+void glrender_begin (int width, int height)
+{
+	glViewport (0, 0, width, height);
+	glScissor (0, 0, width, height);
+
+	glClearColor (0.0f, 0.0f, 0.0f, 0.0f);
+	glClear (GL_COLOR_BUFFER_BIT);
+}
+
+/* draw all slots over what is in the color buffer, blended the way the
+ * caller has set up. parked slots fall outside the view. the end points are
+ * drawn as well, because zero length lines don't get drawn. leaves the
+ * matrices set up for drawing in vectrex coordinates.
+ */
+
+void glrender_draw (float line_width)
+{
+	const char *base;
+
+	glMatrixMode (GL_PROJECTION);
+	glLoadIdentity ();
+	glOrtho (0, -ALG_MAX_X, ALG_MAX_Y, 0, 1.0, 50.0);
+
+	glMatrixMode (GL_MODELVIEW);
+	glLoadIdentity ();
+	gluLookAt (0.0f, 0.0f, -10.0f,	/* eye-position */
+			   0.0f, 0.0f, 0.0f,	/* view-point */
+			   0.0f, 1.0f, 0.0f);	/* up-vector */
+
+	glEnable (GL_LINE_SMOOTH);
+	glLineWidth (line_width);
+	glEnable (GL_POINT_SMOOTH);
+	glPointSize (line_width);
+
+	if (slots == 0) {
+		return;
+	}
+
+	glPushMatrix ();
+	glTranslatef ((GLfloat) GLR_CENTER_X, (GLfloat) GLR_CENTER_Y, 0.0f);
+
+	if (vbo != 0) {
+		glr_bindbuffer (GLR_ARRAY_BUFFER, vbo);
+		base = NULL;
+	} else {
+		base = (const char *) verts;
+	}
+
+	glEnableClientState (GL_VERTEX_ARRAY);
+	glEnableClientState (GL_COLOR_ARRAY);
+	glVertexPointer (2, GL_SHORT, sizeof (glrender_vertex_t),
+					 base + offsetof (glrender_vertex_t, x));
+	glColorPointer (4, GL_UNSIGNED_BYTE, sizeof (glrender_vertex_t),
+					base + offsetof (glrender_vertex_t, color));
+
+	glDrawArrays (GL_LINES, 0, (GLsizei) slots * 2);
+
+	/* the points go on at full alpha, as they always have. with only three
+	 * color components per vertex gl takes alpha as 1.
+	 */
+
+	glColorPointer (3, GL_UNSIGNED_BYTE, sizeof (glrender_vertex_t),
+					base + offsetof (glrender_vertex_t, color));
+	glDrawArrays (GL_POINTS, 0, (GLsizei) slots * 2);
+
+	glDisableClientState (GL_COLOR_ARRAY);
+	glDisableClientState (GL_VERTEX_ARRAY);
+
+	if (vbo != 0) {
+		glr_bindbuffer (GLR_ARRAY_BUFFER, 0);
+	}
+
+	glPopMatrix ();
+}
@@ -0,0 +1,24 @@
+#ifndef __GLRENDER_H
+#define __GLRENDER_H
+
+#include "vecx.h"
+
+/* opengl vector renderer. it mirrors the slots of a live vector set in one
+ * packed array of 16-bit end points and 8-bit colors, streams the slots that
+ * changed into a vertex buffer object and draws every line and its end
+ * points in two calls. without vertex buffer objects (before opengl 1.5 and
+ * without GL_ARB_vertex_buffer_object) it draws from the array in memory.
+ * needs nothing but a current opengl context, so any window system or
+ * offscreen target can use it.
+ */
+
+typedef void *(*glrender_getproc_fn) (const char *name);
+
+int glrender_init (glrender_getproc_fn getproc);
+void glrender_done (void);
+
+void glrender_update (vecx_live_t *live, const float *color_set);
+void glrender_begin (int width, int height);
+void glrender_draw (float line_width);
+
+#endif
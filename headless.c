@@ -0,0 +1,786 @@
+/* headless front end for vecx.
+ *
+ * runs the emulator as fast as the host allows with no video, audio or
+ * input device. every finished frame is handed to a sink which either
+ * throws it away, dumps the vector list as text, folds it into a hash,
+ * tracks what changed from the last frame or draws it in software with
+ * any number of threads, so the same binary serves both as a throughput
+ * benchmark and as a regression runner on machines without a display.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "e6809.h"
+#include "vecx.h"
+#include "bios.h"
+#include "raster.h"
+#ifdef HL_EGL
+#include "glrender.h"
+#include "offscreen.h"
+#endif
+
+enum {
+	HL_FRAMES		= 3000,	/* default run length, 100 emulated seconds */
+	HL_CHUNK		= VECTREX_MHZ / 50,
+	HL_INPUT_HOLD	= 15,	/* frames each pseudo-random input is held */
+	HL_WIDTH		= 330,	/* size of rendered images, as the vecxgl window */
+	HL_HEIGHT		= 410,
+	HL_SS			= 2		/* samples per pixel along each axis in software */
+};
+
+typedef struct hl_sink {
+	const char *name;
+	void (*frame) (const vecx_frame_t *frame);
+	void (*done) (void);
+} hl_sink_t;
+
+static vecx_t vecx;
+
+static const char *romname = NULL;
+static const char *cartname = NULL;
+static const char *outname = NULL;
+static FILE *outfile = NULL;
+
+static long frame_target = HL_FRAMES;
+static long frame_cnt;
+
+static unsigned long input_seed;
+static int input_random = 0;
+
+static unsigned long frame_hash;
+static unsigned long run_hash;
+
+static int image_width = HL_WIDTH;
+static int image_height = HL_HEIGHT;
+static int image_ss = HL_SS;
+static float image_line_width = 1.0f;
+static int image_threads = 0;	/* 0 until given with -t */
+
+/* verification: per-frame hashes of the lock-step reference run and the
+ * first frame of the checked run that differs from it.
+ */
+
+static int verify = 0;
+static unsigned long *verify_hash;
+static long verify_bad;
+
+/* host wall clock in seconds */
+
+static double hl_time (void)
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, now;
+
+	QueryPerformanceFrequency (&freq);
+	QueryPerformanceCounter (&now);
+
+	return (double) now.QuadPart / (double) freq.QuadPart;
+#else
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+#endif
+}
+
+/* 32-bit fnv-1a, fed one value at a time so the result does not depend on
+ * the in-memory layout of the vector list.
+ */
+
+static unsigned long hl_hash (unsigned long h, unsigned long value)
+{
+	unsigned b;
+
+	for (b = 0; b < 4; b++) {
+		h ^= value & 0xff;
+		h = (h * 16777619UL) & 0xffffffffUL;
+		value >>= 8;
+	}
+
+	return h;
+}
+
+/* sink: none */
+
+static void sink_none_frame (const vecx_frame_t *frame)
+{
+}
+
+static void sink_none_done (void)
+{
+}
+
+/* sink: dump, one header line per frame followed by one line per vector */
+
+static void sink_dump_frame (const vecx_frame_t *frame)
+{
+	long v;
+
+	fprintf (outfile, "frame %ld %ld\n", frame_cnt, frame->cnt);
+
+	for (v = 0; v < frame->cnt; v++) {
+		fprintf (outfile, "%u %u %u %u %u\n",
+				 frame->x0[v], frame->y0[v], frame->x1[v], frame->y1[v],
+				 frame->color[v]);
+	}
+}
+
+static void sink_dump_done (void)
+{
+}
+
+static unsigned long hl_frame_hash (const vecx_frame_t *frame)
+{
+	unsigned long h;
+	long v;
+
+	h = 2166136261UL;
+	h = hl_hash (h, (unsigned long) frame->cnt);
+
+	for (v = 0; v < frame->cnt; v++) {
+		h = hl_hash (h, frame->x0[v]);
+		h = hl_hash (h, frame->y0[v]);
+		h = hl_hash (h, frame->x1[v]);
+		h = hl_hash (h, frame->y1[v]);
+		h = hl_hash (h, frame->color[v]);
+	}
+
+	return h;
+}
+
+/* what verification compares at the end of a frame: the vectors, ram and,
+ * unless a bios routine emulated at a high level may be halfway through
+ * with its registers still off the cpu, the cpu registers.
+ */
+
+static unsigned long hl_verify_hash (const vecx_frame_t *frame)
+{
+	e6809_regs_t regs;
+	unsigned long h;
+	unsigned r;
+
+	h = hl_frame_hash (frame);
+
+	for (r = 0; r < sizeof (vecx.ram); r++) {
+		h = hl_hash (h, vecx.ram[r]);
+	}
+
+	if (!vecx.hle_enable) {
+		e6809_get_regs (&vecx.cpu, &regs);
+
+		h = hl_hash (h, regs.a | regs.b << 8 | regs.dp << 16 | regs.cc << 24);
+		h = hl_hash (h, regs.x | regs.y << 16);
+		h = hl_hash (h, regs.u | regs.s << 16);
+		h = hl_hash (h, regs.pc);
+	}
+
+	return h;
+}
+
+/* sink: hash, a per-frame hash folded into a hash for the whole run.
+ * per-frame hashes are only written out when an output file was given.
+ */
+
+static void sink_hash_frame (const vecx_frame_t *frame)
+{
+	frame_hash = hl_frame_hash (frame);
+
+	run_hash = hl_hash (run_hash, frame_hash);
+
+	if (outname != NULL) {
+		fprintf (outfile, "%ld %08lx\n", frame_cnt, frame_hash);
+	}
+}
+
+static void sink_hash_done (void)
+{
+	printf ("%08lx\n", run_hash);
+}
+
+/* sink: live, keeps the vectors on screen the way an incremental renderer
+ * does and reports how much of each frame it would have had to redraw.
+ */
+
+static vecx_live_t live;
+static unsigned long live_vectors;
+static unsigned long live_changes;
+static long live_still;
+
+static void sink_live_frame (const vecx_frame_t *frame)
+{
+	long n;
+
+	n = vecx_live_update (&live, frame);
+	vecx_live_clean (&live);
+
+	live_vectors += frame->cnt;
+	live_changes += n;
+
+	if (n == 0) {
+		live_still++;
+	}
+}
+
+static void sink_live_done (void)
+{
+	fprintf (outfile, "%lu vectors, %lu slot changes (%.1f%%), %ld frames unchanged, %ld slots\n",
+			 live_vectors, live_changes,
+			 live_vectors ? 100.0 * live_changes / live_vectors : 0.0,
+			 live_still, live.cnt);
+
+	vecx_live_done (&live);
+}
+
+static raster_t raster;
+static int raster_open;
+static double raster_secs;
+
+static void hl_raster_open (int threads)
+{
+	if (raster_open) {
+		return;
+	}
+
+	if (!raster_init (&raster, image_width, image_height, image_ss,
+					  image_line_width)) {
+		fprintf (stderr, "cannot render %dx%d images at %d samples per pixel\n",
+				 image_width, image_height, image_ss);
+		exit (1);
+	}
+
+	if (raster_threads (&raster, threads) < threads) {
+		fprintf (stderr, "cannot start %d drawing threads\n", threads);
+		exit (1);
+	}
+
+	raster_open = 1;
+}
+
+/* sink: pgm, every frame drawn by the software renderer and written out
+ * back to back as binary pgm (P5) images, one 8-bit gray byte per pixel
+ * row by row from the top left, at -S size. reports the time spent
+ * drawing, which is the figure that matters when many instances share a
+ * host.
+ */
+
+static void sink_pgm_frame (const vecx_frame_t *frame)
+{
+	double t0;
+
+	hl_raster_open (image_threads ? image_threads : 1);
+
+	t0 = hl_time ();
+	raster_frame (&raster, frame);
+	raster_secs += hl_time () - t0;
+
+	fprintf (outfile, "P5\n%d %d\n255\n", image_width, image_height);
+	fwrite (raster.image, 1, (size_t) image_width * image_height, outfile);
+}
+
+static void sink_pgm_done (void)
+{
+	if (raster_open) {
+		fprintf (stderr, "raster: %dx%d at %dx%d samples, %d threads, %.3f ms/frame\n",
+				 image_width, image_height, image_ss, image_ss, raster.threads,
+				 frame_cnt ? raster_secs * 1e3 / frame_cnt : 0.0);
+
+		raster_done (&raster);
+	}
+}
+
+/* sink: scale, draws every frame in software once with each number of
+ * threads from 1 up to -t (default one per cpu) and reports how drawing
+ * time scales. every image has to match the one drawn by a single thread.
+ */
+
+static double scale_secs[RASTER_THREADS_MAX + 1];
+static long scale_lines;
+static long scale_bad = -1;
+
+static unsigned long hl_image_hash (void)
+{
+	unsigned long h;
+	long p, n;
+
+	h = 2166136261UL;
+	n = (long) image_width * image_height;
+
+	for (p = 0; p < n; p++) {
+		h = ((h ^ raster.image[p]) * 16777619UL) & 0xffffffffUL;
+	}
+
+	return h;
+}
+
+static void sink_scale_frame (const vecx_frame_t *frame)
+{
+	unsigned long h, h1;
+	double t0;
+	int n;
+
+	if (image_threads == 0) {
+		image_threads = raster_cpus ();
+	}
+
+	hl_raster_open (image_threads);
+
+	scale_lines += frame->cnt;
+	h1 = 0;
+
+	for (n = 1; n <= image_threads; n++) {
+		raster_threads (&raster, n);
+
+		t0 = hl_time ();
+		raster_frame (&raster, frame);
+		scale_secs[n] += hl_time () - t0;
+
+		h = hl_image_hash ();
+
+		if (n == 1) {
+			h1 = h;
+		} else if (h != h1 && scale_bad < 0) {
+			scale_bad = frame_cnt;
+		}
+	}
+}
+
+static void sink_scale_done (void)
+{
+	int n;
+
+	if (!raster_open) {
+		return;
+	}
+
+	fprintf (outfile, "%dx%d at %dx%d samples, %d tiles, %.1f lines/frame\n",
+			 image_width, image_height, image_ss, image_ss,
+			 raster.tw * raster.th,
+			 frame_cnt ? (double) scale_lines / frame_cnt : 0.0);
+
+	fprintf (outfile, "threads  ms/frame  speedup\n");
+
+	for (n = 1; n <= image_threads; n++) {
+		fprintf (outfile, "%7d  %8.3f  %6.2fx\n", n,
+				 frame_cnt ? scale_secs[n] * 1e3 / frame_cnt : 0.0,
+				 scale_secs[n] > 0 ? scale_secs[1] / scale_secs[n] : 0.0);
+	}
+
+	if (scale_bad >= 0) {
+		fprintf (stderr, "scale: frame %ld differs between thread counts\n", scale_bad);
+	}
+
+	raster_done (&raster);
+}
+
+#ifdef HL_EGL
+
+/* sink: ppm, every frame drawn by the opengl renderer of vecxgl into an
+ * offscreen context and written out as a binary ppm image. the images
+ * follow one another in the output, so a single frame gives a screenshot
+ * and more give a stream netpbm tools and video encoders can read.
+ */
+
+static vecx_live_t image_live;
+static unsigned char *image_rgb;
+static int image_open;
+
+static void sink_ppm_frame (const vecx_frame_t *frame)
+{
+	const unsigned char *rgba;
+	long p, n;
+
+	if (!image_open) {
+		if (!offscreen_open (image_width, image_height)) {
+			exit (1);
+		}
+
+		glrender_init (offscreen_getproc);
+
+		image_rgb = malloc ((size_t) image_width * image_height * 3);
+
+		if (image_rgb == NULL) {
+			fprintf (stderr, "out of memory\n");
+			exit (1);
+		}
+
+		image_open = 1;
+	}
+
+	vecx_live_update (&image_live, frame);
+	glrender_update (&image_live, NULL);
+
+	glrender_begin (image_width, image_height);
+	glrender_draw (image_line_width);
+
+	rgba = offscreen_read ();
+	n = (long) image_width * image_height;
+
+	for (p = 0; p < n; p++) {
+		image_rgb[p * 3 + 0] = rgba[p * 4 + 0];
+		image_rgb[p * 3 + 1] = rgba[p * 4 + 1];
+		image_rgb[p * 3 + 2] = rgba[p * 4 + 2];
+	}
+
+	fprintf (outfile, "P6\n%d %d\n255\n", image_width, image_height);
+	fwrite (image_rgb, 3, (size_t) n, outfile);
+}
+
+static void sink_ppm_done (void)
+{
+	if (image_open) {
+		glrender_done ();
+		offscreen_close ();
+		free (image_rgb);
+	}
+
+	vecx_live_done (&image_live);
+}
+
+#endif
+
+static const hl_sink_t sinks[] = {
+	{ "none", sink_none_frame, sink_none_done },
+	{ "dump", sink_dump_frame, sink_dump_done },
+	{ "hash", sink_hash_frame, sink_hash_done },
+	{ "live", sink_live_frame, sink_live_done },
+	{ "pgm", sink_pgm_frame, sink_pgm_done },
+	{ "scale", sink_scale_frame, sink_scale_done },
+#ifdef HL_EGL
+	{ "ppm", sink_ppm_frame, sink_ppm_done },
+#endif
+	{ NULL, NULL, NULL }
+};
+
+static const hl_sink_t *sink = &sinks[2];
+
+/* drive the joystick and buttons from a repeatable pseudo-random sequence
+ * so regression runs exercise more than the attract mode.
+ */
+
+static void hl_input (void)
+{
+	static const unsigned axis[3] = { 0x00, 0x80, 0xff };
+	unsigned r;
+
+	if (frame_cnt % HL_INPUT_HOLD != 0) {
+		return;
+	}
+
+	input_seed = (input_seed * 1103515245UL + 12345UL) & 0x7fffffffUL;
+	r = (unsigned) (input_seed >> 16);
+
+	vecx.alg_jch0 = axis[r % 3];
+	vecx.alg_jch1 = axis[(r / 3) % 3];
+	vecx.snd_regs[14] = 0xf0 | ((r >> 4) & 0x0f);
+}
+
+/* called by vecx_emu at the end of every frame */
+
+static void hl_frame (vecx_frame_t *frame, void *user)
+{
+	if (frame_cnt < frame_target) {
+		if (vecx.lockstep) {
+			/* reference run for verification */
+
+			verify_hash[frame_cnt] = hl_verify_hash (frame);
+		} else {
+			if (verify && verify_bad < 0 &&
+				hl_verify_hash (frame) != verify_hash[frame_cnt]) {
+				verify_bad = frame_cnt;
+			}
+
+			sink->frame (frame);
+		}
+
+		frame_cnt++;
+
+		if (input_random) {
+			hl_input ();
+		}
+	}
+
+	vecx_frame_release (frame);
+}
+
+static vecx_image_t *hl_load (const char *filename, unsigned long size,
+							  int exact)
+{
+	vecx_image_t *img;
+
+	img = vecx_image_map (filename, size);
+
+	if (img == NULL) {
+		fprintf (stderr, "cannot open '%s'\n", filename);
+		exit (1);
+	}
+
+	if (exact && img->size != size) {
+		fprintf (stderr, "'%s' is smaller than %lu bytes\n", filename, size);
+		exit (1);
+	}
+
+	return img;
+}
+
+static void hl_usage (FILE *f)
+{
+	const hl_sink_t *s;
+
+	fprintf (f, "Usage: vecxhl [options] [file]\n");
+	fprintf (f, "Options:\n");
+	fprintf (f, "  -a <#>            Samples per pixel along each axis when drawing in software (default is %d)\n", HL_SS);
+	fprintf (f, "  -b <file>         Load BIOS image from file\n");
+	fprintf (f, "  -f <#>            Number of frames to emulate (default is %d)\n", HL_FRAMES);
+	fprintf (f, "  -h                Display this help\n");
+	fprintf (f, "  -H                Emulate the bios drawing routines at a high level\n");
+	fprintf (f, "  -i <address>      Start of an idle loop in the cartridge (hex, may be repeated)\n");
+	fprintf (f, "  -j                Run hot 6809 code through compiled call stubs (x86-64 only)\n");
+	fprintf (f, "  -l <#>            Width of rendered lines in pixels (default is 1)\n");
+	fprintf (f, "  -o <file>         Write sink output to file\n");
+	fprintf (f, "  -r <#>            Drive the controller from a pseudo-random seed\n");
+	fprintf (f, "  -S <w>x<h>        Size of rendered images (default is %dx%d)\n", HL_WIDTH, HL_HEIGHT);
+	fprintf (f, "  -t <#>            Threads drawing in software (default is 1, or one per cpu to scale)\n");
+	fprintf (f, "  -V                Verify against stepping the hardware after every instruction\n");
+	fprintf (f, "  -s <sink>         Frame sink:");
+
+	for (s = sinks; s->name != NULL; s++) {
+		fprintf (f, " %s", s->name);
+	}
+
+	fprintf (f, " (default is %s)\n", sink->name);
+}
+
+static const char *hl_nextarg (int *index, int argc, char *argv[],
+							   const char *what)
+{
+	if (*index >= argc) {
+		hl_usage (stderr);
+		fprintf (stderr, "\nError : no %s given.\n", what);
+		exit (1);
+	}
+
+	return argv[(*index)++];
+}
+
+static void hl_parse_cmdline (int argc, char *argv[])
+{
+	const hl_sink_t *s;
+	const char *arg;
+	int index;
+
+	index = 1;
+
+	while (index < argc) {
+		arg = argv[index++];
+
+		if (strcmp (arg, "-h") == 0) {
+			hl_usage (stdout);
+			exit (0);
+		} else if (strcmp (arg, "-a") == 0) {
+			image_ss = atoi (hl_nextarg (&index, argc, argv, "sample count for -a"));
+
+			if (image_ss < 1 || image_ss > RASTER_SS_MAX) {
+				hl_usage (stderr);
+				fprintf (stderr, "\nError : -a takes 1 to %d.\n", RASTER_SS_MAX);
+				exit (1);
+			}
+		} else if (strcmp (arg, "-b") == 0) {
+			romname = hl_nextarg (&index, argc, argv, "filename for -b");
+		} else if (strcmp (arg, "-f") == 0) {
+			frame_target = atol (hl_nextarg (&index, argc, argv, "frame count for -f"));
+		} else if (strcmp (arg, "-H") == 0) {
+			vecx.hle_enable = 1;
+		} else if (strcmp (arg, "-i") == 0) {
+			if (vecx.idle_pc_cnt == IDLE_PC_CNT) {
+				hl_usage (stderr);
+				fprintf (stderr, "\nError : -i may be given at most %d times.\n", IDLE_PC_CNT);
+				exit (1);
+			}
+
+			vecx.idle_pc[vecx.idle_pc_cnt++] = (unsigned) strtoul (hl_nextarg (&index, argc, argv, "address for -i"), NULL, 16);
+		} else if (strcmp (arg, "-j") == 0) {
+			vecx.cpu.jit_enable = 1;
+		} else if (strcmp (arg, "-l") == 0) {
+			image_line_width = (float) atof (hl_nextarg (&index, argc, argv, "width for -l"));
+
+			if (image_line_width <= 0) {
+				hl_usage (stderr);
+				fprintf (stderr, "\nError : bad line width.\n");
+				exit (1);
+			}
+		} else if (strcmp (arg, "-o") == 0) {
+			outname = hl_nextarg (&index, argc, argv, "filename for -o");
+		} else if (strcmp (arg, "-r") == 0) {
+			input_seed = strtoul (hl_nextarg (&index, argc, argv, "seed for -r"), NULL, 0);
+			input_random = 1;
+		} else if (strcmp (arg, "-S") == 0) {
+			arg = hl_nextarg (&index, argc, argv, "size for -S");
+
+			if (sscanf (arg, "%dx%d", &image_width, &image_height) != 2 ||
+				image_width <= 0 || image_height <= 0) {
+				hl_usage (stderr);
+				fprintf (stderr, "\nError : bad size '%s'.\n", arg);
+				exit (1);
+			}
+		} else if (strcmp (arg, "-t") == 0) {
+			image_threads = atoi (hl_nextarg (&index, argc, argv, "thread count for -t"));
+
+			if (image_threads < 1 || image_threads > RASTER_THREADS_MAX) {
+				hl_usage (stderr);
+				fprintf (stderr, "\nError : -t takes 1 to %d.\n", RASTER_THREADS_MAX);
+				exit (1);
+			}
+		} else if (strcmp (arg, "-V") == 0) {
+			verify = 1;
+		} else if (strcmp (arg, "-s") == 0) {
+			arg = hl_nextarg (&index, argc, argv, "sink for -s");
+
+			for (s = sinks; s->name != NULL; s++) {
+				if (strcmp (arg, s->name) == 0) {
+					break;
+				}
+			}
+
+			if (s->name == NULL) {
+				hl_usage (stderr);
+				fprintf (stderr, "\nError : unknown sink '%s'.\n", arg);
+				exit (1);
+			}
+
+			sink = s;
+		} else {
+			cartname = arg;
+		}
+	}
+}
+
+/* emulate frame_target frames from reset */
+
+static double hl_run (void)
+{
+	double cycles;
+
+	frame_cnt = 0;
+	cycles = 0;
+
+	vecx_reset (&vecx);
+
+	while (frame_cnt < frame_target) {
+		cycles += vecx_emu (&vecx, HL_CHUNK, 0);
+	}
+
+	return cycles;
+}
+
+int main (int argc, char *argv[])
+{
+	double t0, t1, secs;
+	double cycles;
+	unsigned long seed;
+	unsigned long vector_bytes;
+	vecx_image_t *img;
+
+	hl_parse_cmdline (argc, argv);
+
+	if (romname != NULL) {
+		img = hl_load (romname, 8192, 1);
+	} else {
+		img = vecx_image_wrap (bios_data, bios_data_size);
+	}
+
+	vecx_set_rom (&vecx, img);
+	vecx_image_release (img);
+
+	if (cartname != NULL) {
+		img = hl_load (cartname, 32768, 0);
+		vecx_set_cart (&vecx, img);
+		vecx_image_release (img);
+	}
+
+	outfile = stdout;
+
+	if (outname != NULL) {
+		outfile = fopen (outname, "w");
+
+		if (outfile == NULL) {
+			fprintf (stderr, "cannot open '%s'\n", outname);
+			return 1;
+		}
+	}
+
+	run_hash = 2166136261UL;
+	seed = input_seed;
+
+	vecx_frame_callback (&vecx, hl_frame, NULL);
+
+	if (verify) {
+		verify_hash = malloc (sizeof (*verify_hash) * (frame_target + 1));
+
+		if (verify_hash == NULL) {
+			fprintf (stderr, "out of memory\n");
+			return 1;
+		}
+
+		vecx.lockstep = 1;
+		hl_run ();
+		vecx.lockstep = 0;
+
+		input_seed = seed;
+		verify_bad = -1;
+	}
+
+	t0 = hl_time ();
+	cycles = hl_run ();
+	t1 = hl_time ();
+	secs = t1 - t0;
+
+	sink->done ();
+
+	vector_bytes = vecx.vector_bytes;
+	vecx_done (&vecx);
+
+	if (outfile != stdout) {
+		fclose (outfile);
+	}
+
+	if (secs <= 0) {
+		secs = 1e-9;
+	}
+
+	fprintf (stderr, "%ld frames, %.0f cycles in %.3f s: %.1f frames/s, %.2f Mcycles/s (%.1fx real time)\n",
+			 frame_cnt, cycles, secs, frame_cnt / secs, cycles / secs / 1e6,
+			 cycles / secs / VECTREX_MHZ);
+
+	fprintf (stderr, "vectors: %lu lines, %lu deduped (%.1f%%), %lu spilled\n",
+			 vecx.vector_lines, vecx.vector_dedups,
+			 vecx.vector_lines ? 100.0 * vecx.vector_dedups / vecx.vector_lines : 0.0,
+			 vecx.vector_spills);
+
+	fprintf (stderr, "vectors: peak %ld per frame, %lu dropped, %lu bytes of lists\n",
+			 vecx.vector_peak, vecx.vector_drops, vector_bytes);
+
+	if (vecx.hle_enable) {
+		fprintf (stderr, "hle: %lu routines, %lu stopped at a wait loop\n",
+				 vecx.hle_calls, vecx.hle_stalls);
+	}
+
+	if (verify) {
+		free (verify_hash);
+
+		if (verify_bad >= 0) {
+			fprintf (stderr, "verify: frame %ld differs from lock-step\n", verify_bad);
+			return 1;
+		}
+
+		fprintf (stderr, "verify: all %ld frames match lock-step\n", frame_cnt);
+	}
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include "offscreen.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA	0x31dd
+#endif
+
+typedef EGLDisplay (*ofs_getdisplay_fn) (EGLenum platform, void *native,
+										 const EGLint *attribs);
+
+static EGLDisplay display = EGL_NO_DISPLAY;
+static EGLSurface surface = EGL_NO_SURFACE;
+static EGLContext context = EGL_NO_CONTEXT;
+
+static int ofs_width;
+static int ofs_height;
+
+static unsigned char *pixels;	/* as read back, bottom row first */
+static unsigned char *image;	/* top row first */
+
+/* the surfaceless platform needs no display server at all. where egl does
+ * not offer it, fall back on the default display.
+ */
+
+static int ofs_display (void)
+{
+	ofs_getdisplay_fn getdisplay;
+
+	getdisplay = (ofs_getdisplay_fn) eglGetProcAddress ("eglGetPlatformDisplayEXT");
+
+	if (getdisplay != NULL) {
+		display = getdisplay (EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+		if (display != EGL_NO_DISPLAY && eglInitialize (display, NULL, NULL)) {
+			return 1;
+		}
+	}
+
+	display = eglGetDisplay (EGL_DEFAULT_DISPLAY);
+
+	if (display != EGL_NO_DISPLAY && eglInitialize (display, NULL, NULL)) {
+		return 1;
+	}
+
+	display = EGL_NO_DISPLAY;
+
+	return 0;
+}
+
+/* open a width x height target and make its context current. returns 0 and
+ * prints why if that is not possible.
+ */
+
+int offscreen_open (int width, int height)
+{
+	static const EGLint config_attribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLint surface_attribs[] = {
+		EGL_WIDTH, 0,
+		EGL_HEIGHT, 0,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint n;
+
+	if (!ofs_display ()) {
+		fprintf (stderr, "offscreen: no egl display\n");
+		return 0;
+	}
+
+	if (!eglBindAPI (EGL_OPENGL_API) ||
+		!eglChooseConfig (display, config_attribs, &config, 1, &n) || n == 0) {
+		fprintf (stderr, "offscreen: no opengl pbuffer config\n");
+		offscreen_close ();
+		return 0;
+	}
+
+	surface_attribs[1] = width;
+	surface_attribs[3] = height;
+
+	surface = eglCreatePbufferSurface (display, config, surface_attribs);
+	context = eglCreateContext (display, config, EGL_NO_CONTEXT, NULL);
+
+	if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT ||
+		!eglMakeCurrent (display, surface, surface, context)) {
+		fprintf (stderr, "offscreen: cannot create a %dx%d context (egl error 0x%x)\n",
+				 width, height, (unsigned) eglGetError ());
+		offscreen_close ();
+		return 0;
+	}
+
+	pixels = malloc ((size_t) width * height * 4);
+	image = malloc ((size_t) width * height * 4);
+
+	if (pixels == NULL || image == NULL) {
+		fprintf (stderr, "offscreen: out of memory\n");
+		offscreen_close ();
+		return 0;
+	}
+
+	ofs_width = width;
+	ofs_height = height;
+
+	return 1;
+}
+
+void offscreen_close (void)
+{
+	if (display != EGL_NO_DISPLAY) {
+		eglMakeCurrent (display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+		if (context != EGL_NO_CONTEXT) {
+			eglDestroyContext (display, context);
+		}
+
+		if (surface != EGL_NO_SURFACE) {
+			eglDestroySurface (display, surface);
+		}
+
+		eglTerminate (display);
+	}
+
+	display = EGL_NO_DISPLAY;
+	surface = EGL_NO_SURFACE;
+	context = EGL_NO_CONTEXT;
+
+	free (pixels);
+	free (image);
+	pixels = NULL;
+	image = NULL;
+}
+
+/* for glrender_init */
+
+void *offscreen_getproc (const char *name)
+{
+	return (void *) eglGetProcAddress (name);
+}
+
+/* wait for rendering to finish and return what was drawn, width x height
+ * rgba pixels with the top row first. valid until the next call.
+ */
+
+const unsigned char *offscreen_read (void)
+{
+	size_t row;
+	int y;
+
+	row = (size_t) ofs_width * 4;
+
+	glPixelStorei (GL_PACK_ALIGNMENT, 1);
+	glReadPixels (0, 0, ofs_width, ofs_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	for (y = 0; y < ofs_height; y++) {
+		memcpy (image + y * row, pixels + (ofs_height - 1 - y) * row, row);
+	}
+
+	return image;
+}
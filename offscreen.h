@@ -0,0 +1,19 @@
+#ifndef __OFFSCREEN_H
+#define __OFFSCREEN_H
+
+/* opengl context with no window, for rendering on machines without a
+ * display server or gpu. it is created through egl, on mesa's surfaceless
+ * platform where there is one, and draws into a pbuffer of a fixed size.
+ * while it is open the context is current on the calling thread, so the
+ * renderer runs into it unchanged and offscreen_read takes the place of
+ * swapping buffers.
+ */
+
+int offscreen_open (int width, int height);
+void offscreen_close (void);
+
+void *offscreen_getproc (const char *name);
+
+const unsigned char *offscreen_read (void);
+
+#endif
@@ -20,9 +20,11 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include "vecx.h"
+#include "e6809.h"
 #include "bios.h"						// bios rom data
 #include "wnoise.h"						// White noise waveform
 #include "overlay.h"					// overlay texture info
+#include "glrender.h"					// vector drawing
 
 static const char *version = "1.2";
 
@@ -35,7 +37,6 @@ static const char *version = "1.2";
 //#define ENABLE_OVERLAY
 
 // AY38910 emulation stuff
-extern unsigned snd_regs[16];
 Uint8 AY_vol[3];
 Uint16 AY_spufreq[3];
 Uint16 AY_noisefreq;
@@ -60,6 +61,28 @@ static long screen_y = DEFAULT_HEIGHT;
 static long scl_factor;
 
 static long bytes_per_pixel;
+static long last_draw_cnt;						// vectors in the last rendered frame
+
+// vectors on screen. glrender mirrors their slots and only rewrites the
+// ones that changed each frame
+static vecx_live_t live;
+static int redraw;								// repaint even if no vector changed
+
+// the emulated vectrex
+static vecx_t vecx;
+
+// state shared between the main (render) thread and the emulation thread
+static volatile int emu_running;				// 0 = quit, 1 = run, 2 = pause
+static vecx_tribuf_t frame_tribuf;
+
+// controller state, only touched by the main thread, and the copy of it
+// published for the emulation thread to latch once per frame: joystick
+// channel 0 in bits 0-7, channel 1 in bits 8-15, buttons (0 = pressed) in
+// bits 16-19
+static unsigned input_jch0 = 0x80;
+static unsigned input_jch1 = 0x80;
+static unsigned input_buttons = 0x0f;
+static volatile long input_word;
 GLfloat color_set[VECTREX_COLORS];
 GLfloat line_width = DEFAULT_LINEWIDTH;
 GLfloat overlay_transparency = DEFAULT_OVERLAYTRANSPARENCY;
@@ -86,7 +109,7 @@ static void osint_updatescale (void)
 
 static int osint_defaults (void)
 {
-	unsigned b;
+	vecx_image_t *img;
 	//FILE *rom_file;
 
 	screen_x = DEFAULT_WIDTH;
@@ -115,13 +138,15 @@ static int osint_defaults (void)
 
 	fclose (rom_file);
 */
-	// JH - built-in bios
-	memcpy(rom, bios_data, bios_data_size);
+	// JH - built-in bios, shared rather than copied
+	img = vecx_image_wrap(bios_data, bios_data_size);
+	if (img == NULL)
+		return 1;
+	vecx_set_rom(&vecx, img);
+	vecx_image_release(img);
 
 	/* the cart is empty by default */
-	for (b = 0; b < sizeof (cart); b++) {
-		cart[b] = 0;
-	}
+	vecx_set_cart(&vecx, NULL);
 
 	return 0;
 }
@@ -129,26 +154,28 @@ static int osint_defaults (void)
 // Load a custom vectrex bios rom
 static void osint_load_bios(const char *filename) {
 
-	FILE *f;
+	vecx_image_t *img;
 
-	f = fopen(filename, "rb");
-	if (!f) {
+	// mapped from the file, not copied
+	img = vecx_image_map(filename, 8192);
+	if (!img) {
 		fprintf(stderr, "Can't open bios image (%s).\n", filename);
 		exit(1);
 	}
 
-	if (sizeof(rom) != fread(rom, 1, sizeof(rom), f)) {
+	if (img->size != 8192) {
 		fprintf(
 			stderr,
 			"%s is not a valid Vectrex BIOS.\n"
 			"It's smaller than %d bytes.\n",
-			filename, sizeof(rom)
+			filename, 8192
 		);
-		fclose(f);
+		vecx_image_release(img);
 		exit(1);
 	}
 
-	fclose(f);
+	vecx_set_rom(&vecx, img);
+	vecx_image_release(img);
 }
 
 static void osint_print_usage(FILE *f) {
@@ -159,6 +186,8 @@ static void osint_print_usage(FILE *f) {
 	fprintf(f, "                    If the -b parameter is omitted,\n");
 	fprintf(f, "                    a built-in BIOS image will be used.\n");
 	fprintf(f, "  -h                Display this help\n");
+	fprintf(f, "  -H                Emulate the BIOS drawing routines at a high level\n");
+	fprintf(f, "  -i <address>      Start of an idle loop in the cartridge (may be repeated)\n");
 	fprintf(f, "  -l <#>            Set line width (default is %d)\n", DEFAULT_LINEWIDTH);
 	fprintf(f, "  -o <file>         Load overlay from file\n");
 	fprintf(f, "  -t <#>            Overlay transparency (0.0 to 1.0, default is %g)\n", DEFAULT_OVERLAYTRANSPARENCY);
@@ -213,6 +242,25 @@ static void osint_parse_cmdline (int argc, char *argv[])
 				osint_load_bios(arg);
 			}
 		}
+		// -H
+		else if ( 0 == strcmp(arg, "-H") ) {
+			vecx.hle_enable = 1;
+		}
+		// -i
+		else if ( 0 == strcmp(arg, "-i") ) {
+			arg = getnextarg(&index, argc, argv);
+			if (!arg) {
+				osint_print_usage(stderr);
+				fprintf(stderr, "\nError : No address given for -i.\n");
+				exit(1);
+			} else if (vecx.idle_pc_cnt == IDLE_PC_CNT) {
+				osint_print_usage(stderr);
+				fprintf(stderr, "\nError : -i may be given at most %d times.\n", IDLE_PC_CNT);
+				exit(1);
+			} else {
+				vecx.idle_pc[vecx.idle_pc_cnt++] = (unsigned) strtoul(arg, NULL, 16);
+			}
+		}
 		// -l
 		else if ( 0 == strcmp(arg, "-l") ) {
 			arg = getnextarg(&index, argc, argv);
@@ -380,7 +428,6 @@ void osint_render (void)
 	// GL rendering code by James Higgs
 	int     width, height;
 	long v;
-	GLfloat c;
 	//GLfloat alpha;
 
     // Get window size (may be different than the requested size)
@@ -389,12 +436,11 @@ void osint_render (void)
 
     height = height > 0 ? height : 1;
 
-    // Set viewport
-    glViewport( 0, 0, width, height );
-	glScissor( 0, 0, width, height );
+    // Set viewport and clear color buffer
+	glrender_begin(width, height);
 
 #ifdef ENABLE_OVERLAY
-	// draw overlay or clear screen if no overlay is used
+	// draw overlay if one is used
 	if (g_overlay.width > 0) {
 		GLfloat alpha = overlay_transparency;
 		glColor3f(alpha, alpha, alpha);
@@ -424,33 +470,9 @@ void osint_render (void)
 			}
 		glEnd();
 		glDisable(GL_TEXTURE_2D);
-	} else {
-	    glClearColor( 0.0f, 0.0f, 0.0f, 0.0f );
-		glClear(GL_COLOR_BUFFER_BIT);
 	}
-#else
-    // Clear color buffer
-	glClearColor( 0.0f, 0.0f, 0.0f, 0.0f );
-	glClear(GL_COLOR_BUFFER_BIT);
 #endif
 
-    // Select and setup the projection matrix
-    glMatrixMode( GL_PROJECTION );
-    glLoadIdentity();
-	glOrtho( 0, -33000, 41000, 0, 1.0, 50.0 );
-
-    // Select and setup the modelview matrix
-    glMatrixMode( GL_MODELVIEW );
-    glLoadIdentity();
-    gluLookAt( 0.0f, 0.0f, -10.0f,    // Eye-position
-               0.0f, 0.0f, 0.0f,   // View-point
-               0.0f, 1.0f, 0.0f );  // Up-vector
-
-	glEnable(GL_LINE_SMOOTH);
-	glLineWidth(line_width);
-	glEnable(GL_POINT_SMOOTH);
-	glPointSize(line_width);
-
 	// blend lines with overlay image
 	if (g_overlay.width > 0) {
 		glEnable(GL_BLEND);
@@ -458,56 +480,35 @@ void osint_render (void)
 		glBlendFunc(GL_DST_COLOR, GL_ONE);
 	}
 
-    glBegin( GL_LINES );
-
-//	// undraw lines from previous frame
-//	// (JH - We actually draw the erase vectors to get a blurry effect)
-//	for (v = 0; v < vector_erse_cnt; v++) {
-//		if (vectors_erse[v].color != VECTREX_COLORS) {
-////				osint_line (vectors_erse[v].x0, vectors_erse[v].y0,
-////							vectors_erse[v].x1, vectors_erse[v].y1, 0);
-//			c = color_set[vectors_draw[v].color];
-//			glColor3f( c*0.5f, c*0.5f, c*0.5f );
-//			glVertex3i( vectors_erse[v].x0, vectors_erse[v].y0, 0 );
-//			glVertex3i( vectors_erse[v].x1, vectors_erse[v].y1, 0 );
-//		}
-//	}
-
 	// draw lines for this frame
-	for (v = 0; v < vector_draw_cnt; v++) {
-//		osint_line (vectors_draw[v].x0, vectors_draw[v].y0,
-//					vectors_draw[v].x1, vectors_draw[v].y1,
-//					vectors_draw[v].color);
-		c = color_set[vectors_draw[v].color];
-		glColor4f( c, c, c, 0.75f );
-		glVertex3i( vectors_draw[v].x0, vectors_draw[v].y0, 0 );
-		glVertex3i( vectors_draw[v].x1, vectors_draw[v].y1, 0 );
+	glrender_draw(line_width);
 
-	}
+    glBegin( GL_LINES );
+	glColor4f( 1.0f, 1.0f, 1.0f, 0.75f );
 
 // DEBUG sound output visualisation
 	if(AY_debug) {
 		glVertex3i( 1000, 20000, 0 );
-		glVertex3i( 1000 + (snd_regs[8] & 0xFF) * 100, 20000,  0 );
+		glVertex3i( 1000 + (vecx.snd_regs[8] & 0xFF) * 100, 20000,  0 );
 
 		glVertex3i( 1000, 20500, 0 );
-		glVertex3i( 1000 + (snd_regs[9] & 0xFF) * 100, 20500,  0 );
+		glVertex3i( 1000 + (vecx.snd_regs[9] & 0xFF) * 100, 20500,  0 );
 
 		glVertex3i( 1000, 21000, 0 );
-		glVertex3i( 1000 + (snd_regs[10] & 0xFF) * 100, 21000,  0 );
+		glVertex3i( 1000 + (vecx.snd_regs[10] & 0xFF) * 100, 21000,  0 );
 
 		glVertex3i( 1000, 24000, 0 );
-		glVertex3i( 1000 + (snd_regs[7] & 0x01) * 100, 24000,  0 );
+		glVertex3i( 1000 + (vecx.snd_regs[7] & 0x01) * 100, 24000,  0 );
 
 		glVertex3i( 1000, 24500, 0 );
-		glVertex3i( 1000 + (snd_regs[7] & 0x08) * 100, 24500,  0 );
+		glVertex3i( 1000 + (vecx.snd_regs[7] & 0x08) * 100, 24500,  0 );
 
 
 		glVertex3i( 1000, 28000, 0 );
-		glVertex3i( 1000 + (snd_regs[0] + snd_regs[1] * 256), 28000,  0 );
+		glVertex3i( 1000 + (vecx.snd_regs[0] + vecx.snd_regs[1] * 256), 28000,  0 );
 
 		glVertex3i( 1000, 28500, 0 );
-		glVertex3i( 1000 + (snd_regs[6] & 0x1F) * 100, 28500,  0 );
+		glVertex3i( 1000 + (vecx.snd_regs[6] & 0x1F) * 100, 28500,  0 );
 
 
 		if(pWave) {
@@ -521,18 +522,8 @@ void osint_render (void)
 
 	glEnd();
 
-	// we have to redraw points, because zero-length line doesn't get drawn
 	glBegin(GL_POINTS);
-	for (v = 0; v < vector_draw_cnt; v++) {
-//		osint_line (vectors_draw[v].x0, vectors_draw[v].y0,
-//					vectors_draw[v].x1, vectors_draw[v].y1,
-//					vectors_draw[v].color);
-		c = color_set[vectors_draw[v].color];
-		glColor3f( c,c,c );
-		glVertex3i( vectors_draw[v].x0, vectors_draw[v].y0, 0 );
-		glVertex3i( vectors_draw[v].x1, vectors_draw[v].y1, 0 );
-	}
-
+	glColor3f( 1.0f, 1.0f, 1.0f );
 	if(AY_debug) {
 		glVertex3i( 1000, 20000, 0 );
 		glVertex3i( 1000, 20500, 0 );
@@ -547,20 +538,82 @@ void osint_render (void)
     SDL_GL_SwapBuffers( );
 }
 
+// called by vecx_emu() on the emulation thread whenever a frame is finished
+static void osint_frame (vecx_frame_t *frame, void *user)
+{
+	vecx_tribuf_publish (&frame_tribuf, frame);
+}
+
+// main thread: make the controller state visible to the emulation thread
+static void osint_publishinput (void)
+{
+	atomic_store(&input_word, (long) (input_jch0 | (input_jch1 << 8) | (input_buttons << 16)));
+}
+
+// emulation thread: take the controller state for the coming frame
+static void osint_latchinput (void)
+{
+	unsigned w;
+
+	w = (unsigned) atomic_load(&input_word);
+
+	vecx.alg_jch0 = w & 0xff;
+	vecx.alg_jch1 = (w >> 8) & 0xff;
+	vecx.snd_regs[14] = (vecx.snd_regs[14] & ~0x0fu) | ((w >> 16) & 0x0f);
+}
+
+// Emulation thread. Runs vecx_emu() in real time, independent of how long
+// rendering and buffer swaps take on the main thread.
+static int osint_emuthread (void *data)
+{
+	Uint32 t0, now;
+
+	t0 = SDL_GetTicks();
+	while (emu_running) {
+		// emulate this "frame" (if not paused)
+		if(1 == emu_running) {
+			osint_latchinput();
+			vecx_emu (&vecx, (VECTREX_MHZ / 1000) * EMU_TIMER, 0);
+		}
+
+		// speed control
+		t0 += EMU_TIMER;
+		now = SDL_GetTicks();
+		if(now < t0)
+			SDL_Delay(t0 - now);
+		else if(now - t0 > 10 * EMU_TIMER)
+			t0 = now;				// fell far behind, don't try to catch up
+	}
+
+	return 0;
+}
+
 void osint_emuloop (void)
 {
 	int frames, running;
-    double t, t0, t1, fps;
+    double t, t1, fps;
     char    titlestr[ 200 ];
     SDL_Event event;
+	SDL_Thread *emuthread;
+	vecx_frame_t *frame;
 	
 	// reset the vectrex hardware
-	vecx_reset ();
+	vecx_frame_callback (&vecx, osint_frame, NULL);
+	vecx_reset (&vecx);
+	osint_publishinput();
 
     frames = 0;
 	running = 1;
-	t0 = SDL_GetTicks();
-	t1 = t0;
+	redraw = 1;
+	t1 = SDL_GetTicks();
+
+	emu_running = running;
+	emuthread = SDL_CreateThread(osint_emuthread, NULL);
+	if (!emuthread) {
+		fprintf( stderr, "Couldn't create emulation thread: %s\n", SDL_GetError( ) );
+		return;
+	}
+
 	while (running) {
 
 	    // Grab all the events off the queue. 
@@ -570,28 +623,28 @@ void osint_emuloop (void)
 				// Handle key presses
 				switch(event.key.keysym.sym) {
 					case SDLK_LEFT :
-						alg_jch0 = 0x00;
+						input_jch0 = 0x00;
 						break;
 					case SDLK_RIGHT :
-						alg_jch0 = 0xFF;
+						input_jch0 = 0xFF;
 						break;
 					case SDLK_UP :
-						alg_jch1 = 0xFF;
+						input_jch1 = 0xFF;
 						break;
 					case SDLK_DOWN :
-						alg_jch1 = 0x00;
+						input_jch1 = 0x00;
 						break;
 					case SDLK_a :
-						snd_regs[14] &= ~0x01;
+						input_buttons &= ~0x01;
 						break;
 					case SDLK_s :
-						snd_regs[14] &= ~0x02;
+						input_buttons &= ~0x02;
 						break;
 					case SDLK_d:
-						snd_regs[14] &= ~0x04;
+						input_buttons &= ~0x04;
 						break;
 					case SDLK_f :
-						snd_regs[14] &= ~0x08;
+						input_buttons &= ~0x08;
 						break;
 					case SDLK_p :					// pause
 					case SDLK_SPACE :
@@ -618,31 +671,34 @@ void osint_emuloop (void)
 				// Handle key releases
 				switch(event.key.keysym.sym) {
 					case SDLK_LEFT :
-						alg_jch0 = 0x80;
+						input_jch0 = 0x80;
 						break;
 					case SDLK_RIGHT :
-						alg_jch0 = 0x80;
+						input_jch0 = 0x80;
 						break;
 					case SDLK_UP :
-						alg_jch1 = 0x80;
+						input_jch1 = 0x80;
 						break;
 					case SDLK_DOWN :
-						alg_jch1 = 0x80;
+						input_jch1 = 0x80;
 						break;
 					case SDLK_a :
-						snd_regs[14] |= 0x01;
+						input_buttons |= 0x01;
 						break;
 					case SDLK_s :
-						snd_regs[14] |= 0x02;
+						input_buttons |= 0x02;
 						break;
 					case SDLK_d:
-						snd_regs[14] |= 0x04;
+						input_buttons |= 0x04;
 						break;
 					case SDLK_f :
-						snd_regs[14] |= 0x08;
+						input_buttons |= 0x08;
 						break;
 				} //end switch keyup
 				break;
+			case SDL_VIDEOEXPOSE:
+				redraw = 1;
+				break;
 			case SDL_QUIT:
 				/* Handle quit requests (like Ctrl-c). */
 				running = 0;
@@ -651,6 +707,9 @@ void osint_emuloop (void)
 
 		} // wend events
 
+		osint_publishinput();
+		emu_running = running;
+
         // Calculate and display Window caption info
 		if(2 == running) {
 			SDL_WM_SetCaption("VecX/SDL/GL (PAUSED)", NULL);
@@ -677,26 +736,48 @@ void osint_emuloop (void)
 				if( (t-t1) >= 1000)
 				{
 					fps = (double)frames;
-					sprintf( titlestr, "VecX/SDL/GL (%.1f FPS) Drawn: %d ", 
-							fps, vector_draw_cnt );
+					sprintf( titlestr, "VecX/SDL/GL (%.1f FPS) Drawn: %ld ", 
+							fps, last_draw_cnt );
 					SDL_WM_SetCaption(titlestr, NULL);
 					t1 = t;
 					frames = 0;
 				}
 			}
-	        frames ++;
 		}
 
-		// emulate this "frame" (if not paused)
-		if(1 == running)
-			vecx_emu ((VECTREX_MHZ / 1000) * EMU_TIMER, 0);
+		// take in the newest frame the emulation thread has finished. the
+		// screen is only repainted if it differs from the last one drawn
+		frame = vecx_tribuf_acquire (&frame_tribuf);
+		if (frame) {
+			if (vecx_live_update (&live, frame) > 0)
+				redraw = 1;
+			last_draw_cnt = frame->cnt;
+			vecx_frame_release (frame);
+			frames ++;
+		}
 
-		// speed control
-		while(SDL_GetTicks() < (t0 + EMU_TIMER)) ;
-		t0 = SDL_GetTicks();
+		if (redraw || (frame && AY_debug)) {
+			glrender_update (&live, color_set);
+			osint_render ();
+			redraw = 0;
+		}
+		else if (!frame) {
+			SDL_Delay(1);
+		}
 
 	} // wend running
 
+	emu_running = 0;
+	SDL_WaitThread(emuthread, NULL);
+
+	frame = vecx_tribuf_acquire (&frame_tribuf);
+	if (frame)
+		vecx_frame_release (frame);
+
+	vecx_done (&vecx);
+	vecx_live_done (&live);
+	glrender_done ();
+
 printf("Exit emuloop.\n");
 }
 
@@ -831,30 +912,30 @@ static void fillsoundbuffer(void *userdata, Uint8 *stream, int len) {
 	Uint8 val[3];
 	Uint8 lastval;
 
-    AY_tone_enable[0] = snd_regs[7] & 0x01;
-    AY_tone_enable[1] = snd_regs[7] & 0x02;
-    AY_tone_enable[2] = snd_regs[7] & 0x04;
+    AY_tone_enable[0] = vecx.snd_regs[7] & 0x01;
+    AY_tone_enable[1] = vecx.snd_regs[7] & 0x02;
+    AY_tone_enable[2] = vecx.snd_regs[7] & 0x04;
 
-    AY_noise_enable[0] = snd_regs[7] & 0x08;
-    AY_noise_enable[1] = snd_regs[7] & 0x10;
-    AY_noise_enable[2] = snd_regs[7] & 0x20;
+    AY_noise_enable[0] = vecx.snd_regs[7] & 0x08;
+    AY_noise_enable[1] = vecx.snd_regs[7] & 0x10;
+    AY_noise_enable[2] = vecx.snd_regs[7] & 0x20;
 
     // calc noise freq
-    divisor = (snd_regs[6] & 0x1F) << 4;
+    divisor = (vecx.snd_regs[6] & 0x1F) << 4;
     if(divisor == 0) divisor = 256;
     
     AY_noisefreq = (440 * 213) / divisor;
 
     // calc tone freq and vols
     for(i=0; i<3; i++) {
-        //divisor = snd_regs[i*2] + snd_regs[i*2+1] * 256;
-        divisor = snd_regs[i*2] | (snd_regs[i*2+1] << 8);
+        //divisor = vecx.snd_regs[i*2] + vecx.snd_regs[i*2+1] * 256;
+        divisor = vecx.snd_regs[i*2] | (vecx.snd_regs[i*2+1] << 8);
         if(divisor == 0) divisor = 4095;
 
         //AY_spufreq[i] = (440 * 213) / divisor;
 		AY_spufreq[i] = divisor;
 
-        AY_vol[i] = (snd_regs[8+i] & 0x0F) << 2; //<< 9;
+        AY_vol[i] = (vecx.snd_regs[8+i] & 0x0F) << 2; //<< 9;
 
     }
 
@@ -957,7 +1038,7 @@ static void fillsoundbuffer(void *userdata, Uint8 *stream, int len) {
 int main(int argc, char *argv[] )
 {
 	char msg[1024];
-	FILE *cartfile;
+	vecx_image_t *cartimg;
 
 
     /* Information about the current video settings. */
@@ -970,11 +1051,11 @@ int main(int argc, char *argv[] )
 
 	osint_parse_cmdline (argc, argv);
 
-	cartfile = fopen (cartname, "rb");
+	cartimg = vecx_image_map (cartname, 32768);
 
-	if (cartfile != NULL) {
-		fread (cart, 1, sizeof (cart), cartfile);
-		fclose (cartfile);
+	if (cartimg != NULL) {
+		vecx_set_cart (&vecx, cartimg);
+		vecx_image_release (cartimg);
 	} else {
 		sprintf (msg, "cannot open '%s'", cartname);
 		fprintf(stderr, msg);
@@ -984,6 +1065,9 @@ int main(int argc, char *argv[] )
 	info = init_sdl();
     //setup_opengl( width, height );
 
+	if (!glrender_init ((glrender_getproc_fn) SDL_GL_GetProcAddress))
+		fprintf(stderr, "No vertex buffer objects, drawing from memory\n");
+
 	/* determine a set of colors to use based */
 	osint_gencolors ();
 
@@ -0,0 +1,192 @@
+/* cpu probes for vecx, run by make check.
+ *
+ * each probe is a bios image that runs one instruction in a loop, here the
+ * software interrupts, whose handler counts the calls in ram and returns.
+ * the loops get hot enough to be compiled, so running them with compiled
+ * code against lock-step checks that every instruction which jumps through
+ * a vector ends a compiled block. without the block compiler both runs
+ * interpret and trivially match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "e6809.h"
+#include "vecx.h"
+
+enum {
+	PROBE_FRAMES	= 50,
+	PROBE_CHUNK		= VECTREX_MHZ / 50
+};
+
+typedef struct probe {
+	const char *name;
+	unsigned char op[2];
+	unsigned len;
+} probe_t;
+
+static const probe_t probes[] = {
+	{ "swi", { 0x3f, 0x00 }, 1 },
+	{ "swi2", { 0x10, 0x3f }, 2 },
+	{ "swi3", { 0x11, 0x3f }, 2 }
+};
+
+static vecx_t vecx;
+static unsigned char probe_rom[8192];
+
+/* state hash of every frame of the lock-step run, the frames of the
+ * current run so far and the first one that differed.
+ */
+
+static unsigned long probe_hash[PROBE_FRAMES];
+static long frame_cnt;
+static long frame_bad;
+
+/* 32-bit fnv-1a over the bytes of value */
+
+static unsigned long probe_fnv (unsigned long h, unsigned long value)
+{
+	unsigned b;
+
+	for (b = 0; b < 4; b++) {
+		h ^= value & 0xff;
+		h = (h * 16777619UL) & 0xffffffffUL;
+		value >>= 8;
+	}
+
+	return h;
+}
+
+/* ram and cpu registers at the end of a frame */
+
+static unsigned long probe_state (void)
+{
+	e6809_regs_t regs;
+	unsigned long h;
+	unsigned r;
+
+	h = 2166136261UL;
+
+	for (r = 0; r < sizeof (vecx.ram); r++) {
+		h = probe_fnv (h, vecx.ram[r]);
+	}
+
+	e6809_get_regs (&vecx.cpu, &regs);
+
+	h = probe_fnv (h, regs.a | regs.b << 8 | regs.dp << 16 | regs.cc << 24);
+	h = probe_fnv (h, regs.x | regs.y << 16);
+	h = probe_fnv (h, regs.u | regs.s << 16);
+	h = probe_fnv (h, regs.pc);
+
+	return h;
+}
+
+static void probe_frame (vecx_frame_t *frame, void *user)
+{
+	unsigned long h;
+
+	if (frame_cnt < PROBE_FRAMES) {
+		h = probe_state ();
+
+		if (vecx.lockstep) {
+			probe_hash[frame_cnt] = h;
+		} else if (frame_bad < 0 && h != probe_hash[frame_cnt]) {
+			frame_bad = frame_cnt;
+		}
+
+		frame_cnt++;
+	}
+
+	vecx_frame_release (frame);
+}
+
+static void probe_build (const probe_t *p)
+{
+	static const unsigned char handler[] = {
+		0x7c, 0xc8, 0x80,			/* inc $c880 */
+		0x3b						/* rti */
+	};
+	unsigned char *r;
+	unsigned v;
+
+	memset (probe_rom, 0, sizeof (probe_rom));
+
+	/* e000: lds #$cb00 ; the instruction ; bra back to it */
+
+	r = probe_rom;
+	*r++ = 0x10;
+	*r++ = 0xce;
+	*r++ = 0xcb;
+	*r++ = 0x00;
+	memcpy (r, p->op, p->len);
+	r += p->len;
+	*r++ = 0x20;
+	*r++ = (unsigned char) (0x100 - 2 - p->len);
+
+	/* e100: handler, entered through the swi3, swi2 and swi vectors */
+
+	memcpy (probe_rom + 0x100, handler, sizeof (handler));
+
+	for (v = 0x1ff2; v <= 0x1ffa; v += 2) {
+		probe_rom[v] = 0xe1;
+		probe_rom[v + 1] = 0x00;
+	}
+
+	probe_rom[0x1ffe] = 0xe0;
+	probe_rom[0x1fff] = 0x00;
+}
+
+/* PROBE_FRAMES frames from reset */
+
+static void probe_run (void)
+{
+	frame_cnt = 0;
+
+	vecx_reset (&vecx);
+
+	while (frame_cnt < PROBE_FRAMES) {
+		vecx_emu (&vecx, PROBE_CHUNK, 0);
+	}
+}
+
+int main (int argc, char *argv[])
+{
+	vecx_image_t *img;
+	unsigned i;
+	int bad;
+
+	bad = 0;
+
+	vecx_frame_callback (&vecx, probe_frame, NULL);
+
+	for (i = 0; i < sizeof (probes) / sizeof (probes[0]); i++) {
+		probe_build (probes + i);
+
+		img = vecx_image_wrap (probe_rom, sizeof (probe_rom));
+		vecx_set_rom (&vecx, img);
+		vecx_image_release (img);
+
+		vecx.lockstep = 1;
+		vecx.cpu.jit_enable = 0;
+		probe_run ();
+
+		vecx.lockstep = 0;
+		vecx.cpu.jit_enable = 1;
+		frame_bad = -1;
+		probe_run ();
+
+		if (frame_bad >= 0) {
+			printf ("probe %s: frame %ld differs from lock-step\n",
+					probes[i].name, frame_bad);
+			bad = 1;
+		} else {
+			printf ("probe %s: all %d frames match lock-step\n",
+					probes[i].name, PROBE_FRAMES);
+		}
+	}
+
+	vecx_done (&vecx);
+
+	return bad;
+}
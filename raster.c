@@ -0,0 +1,836 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
+#include "vecx.h"
+#include "raster.h"
+
+/* a line set up for drawing, in samples. the coverage of a sample falls
+ * from 1 to 0 over the last sample before edge, measured from the segment
+ * between the end points.
+ */
+
+typedef struct raster_line {
+	float ax, ay;	/* start point */
+	float dx, dy;	/* start to end point */
+	float inv;		/* 1 / (dx * dx + dy * dy), 0 if the line is a point */
+	float edge;
+	float level;	/* intensity at full coverage */
+} raster_line_t;
+
+/* a tile covers the samples [x0, x1) x [y0, y1) and lists the lines of the
+ * frame that come near them.
+ */
+
+typedef struct raster_tile {
+	int x0, y0, x1, y1;
+	long *bin;
+	long cnt;
+	long cap;
+} raster_tile_t;
+
+#ifdef _WIN32
+typedef HANDLE raster_sem_t;
+typedef HANDLE raster_thread_t;
+#else
+typedef sem_t raster_sem_t;
+typedef pthread_t raster_thread_t;
+#endif
+
+/* each worker waits for a start token, takes tiles until there are none
+ * left and hands back a done token. the drawing thread hands out one start
+ * token per worker it wants and waits for as many done tokens.
+ */
+
+typedef struct raster_pool {
+	raster_t *r;
+	volatile long next;		/* tiles handed out so far, and then some */
+	volatile long quit;
+	raster_sem_t start;
+	raster_sem_t done;
+	int workers;
+	raster_thread_t thread[RASTER_THREADS_MAX];
+} raster_pool_t;
+
+int raster_init (raster_t *r, int width, int height, int ss, float line_width)
+{
+	raster_tile_t *tile;
+	int tx, ty, ts;
+
+	memset (r, 0, sizeof (*r));
+
+	if (width <= 0 || height <= 0 || ss < 1 || ss > RASTER_SS_MAX ||
+		line_width <= 0.0f) {
+		return 0;
+	}
+
+	r->width = width;
+	r->height = height;
+	r->ss = ss;
+	r->line_width = line_width;
+	r->sw = width * ss;
+	r->sh = height * ss;
+	r->threads = 1;
+
+	r->image = calloc ((size_t) width * height, 1);
+
+	if (ss == 1) {
+		r->samples = r->image;
+	} else {
+		r->samples = calloc ((size_t) r->sw * r->sh, 1);
+	}
+
+	r->cw = (width + RASTER_CHUNK - 1) / RASTER_CHUNK;
+	r->dirty = calloc ((size_t) r->sh * r->cw, 1);
+
+	r->tw = (width + RASTER_TILE - 1) / RASTER_TILE;
+	r->th = (height + RASTER_TILE - 1) / RASTER_TILE;
+	r->tiles = calloc ((size_t) r->tw * r->th, sizeof (*r->tiles));
+
+	if (r->image == NULL || r->samples == NULL || r->dirty == NULL ||
+		r->tiles == NULL) {
+		raster_done (r);
+		return 0;
+	}
+
+	ts = RASTER_TILE * ss;
+
+	for (ty = 0; ty < r->th; ty++) {
+		for (tx = 0; tx < r->tw; tx++) {
+			tile = r->tiles + ty * r->tw + tx;
+
+			tile->x0 = tx * ts;
+			tile->y0 = ty * ts;
+			tile->x1 = (tile->x0 + ts < r->sw) ? tile->x0 + ts : r->sw;
+			tile->y1 = (tile->y0 + ts < r->sh) ? tile->y0 + ts : r->sh;
+		}
+	}
+
+	return 1;
+}
+
+static void raster_pool_stop (raster_t *r);
+
+void raster_done (raster_t *r)
+{
+	int t;
+
+	raster_pool_stop (r);
+
+	if (r->tiles != NULL) {
+		for (t = 0; t < r->tw * r->th; t++) {
+			free (r->tiles[t].bin);
+		}
+	}
+
+	if (r->samples != r->image) {
+		free (r->samples);
+	}
+
+	free (r->image);
+	free (r->dirty);
+	free (r->lines);
+	free (r->tiles);
+
+	memset (r, 0, sizeof (*r));
+}
+
+static int raster_setup (raster_t *r, const vecx_frame_t *frame, long v,
+						 raster_line_t *line)
+{
+	float sx, sy, len2;
+
+	if (frame->color[v] == 0) {
+		return 0;
+	}
+
+	sx = (float) r->sw / ALG_MAX_X;
+	sy = (float) r->sh / ALG_MAX_Y;
+
+	line->ax = frame->x0[v] * sx;
+	line->ay = frame->y0[v] * sy;
+	line->dx = ((long) frame->x1[v] - (long) frame->x0[v]) * sx;
+	line->dy = ((long) frame->y1[v] - (long) frame->y0[v]) * sy;
+
+	len2 = line->dx * line->dx + line->dy * line->dy;
+	line->inv = (len2 > 0.0f) ? 1.0f / len2 : 0.0f;
+
+	line->edge = r->line_width * r->ss * 0.5f + 0.5f;
+	line->level = frame->color[v] * 255.0f / (VECTREX_COLORS - 1);
+
+	return 1;
+}
+
+/* n samples of a row, starting at x. qy is the offset of the row from the
+ * start of the line. avx2 takes 8 samples at a time, sse2 4 of what is left.
+ */
+
+static void raster_span (unsigned char *p, int x, int n, float qy,
+						 const raster_line_t *line)
+{
+	float qx, t, ex, ey, c;
+	int i, level;
+
+	i = 0;
+
+#if defined(__AVX2__)
+	{
+		__m256 vdx, vdy, vinv, vedge, vlevel, vqy, vqydy, vzero, vone;
+		__m256 vqx, vt, vex, vey, vc;
+		__m256i vi;
+		__m128i lo, hi, out;
+
+		vdx = _mm256_set1_ps (line->dx);
+		vdy = _mm256_set1_ps (line->dy);
+		vinv = _mm256_set1_ps (line->inv);
+		vedge = _mm256_set1_ps (line->edge);
+		vlevel = _mm256_set1_ps (line->level);
+		vqy = _mm256_set1_ps (qy);
+		vqydy = _mm256_set1_ps (qy * line->dy);
+		vzero = _mm256_setzero_ps ();
+		vone = _mm256_set1_ps (1.0f);
+
+		qx = x + 0.5f - line->ax;
+		vqx = _mm256_setr_ps (qx, qx + 1, qx + 2, qx + 3,
+							  qx + 4, qx + 5, qx + 6, qx + 7);
+
+		for (; i + 8 <= n; i += 8) {
+			vt = _mm256_mul_ps (_mm256_add_ps (_mm256_mul_ps (vqx, vdx), vqydy), vinv);
+			vt = _mm256_min_ps (_mm256_max_ps (vt, vzero), vone);
+			vex = _mm256_sub_ps (vqx, _mm256_mul_ps (vt, vdx));
+			vey = _mm256_sub_ps (vqy, _mm256_mul_ps (vt, vdy));
+			vc = _mm256_sub_ps (vedge, _mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (vex, vex),
+																	  _mm256_mul_ps (vey, vey))));
+			vc = _mm256_min_ps (_mm256_max_ps (vc, vzero), vone);
+
+			vi = _mm256_cvttps_epi32 (_mm256_mul_ps (vc, vlevel));
+			lo = _mm256_castsi256_si128 (vi);
+			hi = _mm256_extracti128_si256 (vi, 1);
+			out = _mm_packus_epi16 (_mm_packs_epi32 (lo, hi), _mm_setzero_si128 ());
+			out = _mm_max_epu8 (out, _mm_loadl_epi64 ((const __m128i *) (p + i)));
+			_mm_storel_epi64 ((__m128i *) (p + i), out);
+
+			vqx = _mm256_add_ps (vqx, _mm256_set1_ps (8.0f));
+		}
+	}
+#endif
+#if defined(__SSE2__)
+	{
+		__m128 vdx, vdy, vinv, vedge, vlevel, vqy, vqydy, vzero, vone;
+		__m128 vqx, vt, vex, vey, vc;
+		__m128i out;
+		int dst;
+
+		vdx = _mm_set1_ps (line->dx);
+		vdy = _mm_set1_ps (line->dy);
+		vinv = _mm_set1_ps (line->inv);
+		vedge = _mm_set1_ps (line->edge);
+		vlevel = _mm_set1_ps (line->level);
+		vqy = _mm_set1_ps (qy);
+		vqydy = _mm_set1_ps (qy * line->dy);
+		vzero = _mm_setzero_ps ();
+		vone = _mm_set1_ps (1.0f);
+
+		qx = x + i + 0.5f - line->ax;
+		vqx = _mm_setr_ps (qx, qx + 1, qx + 2, qx + 3);
+
+		for (; i + 4 <= n; i += 4) {
+			vt = _mm_mul_ps (_mm_add_ps (_mm_mul_ps (vqx, vdx), vqydy), vinv);
+			vt = _mm_min_ps (_mm_max_ps (vt, vzero), vone);
+			vex = _mm_sub_ps (vqx, _mm_mul_ps (vt, vdx));
+			vey = _mm_sub_ps (vqy, _mm_mul_ps (vt, vdy));
+			vc = _mm_sub_ps (vedge, _mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (vex, vex),
+															 _mm_mul_ps (vey, vey))));
+			vc = _mm_min_ps (_mm_max_ps (vc, vzero), vone);
+
+			out = _mm_cvttps_epi32 (_mm_mul_ps (vc, vlevel));
+			out = _mm_packs_epi32 (out, out);
+			out = _mm_packus_epi16 (out, out);
+
+			memcpy (&dst, p + i, 4);
+			out = _mm_max_epu8 (out, _mm_cvtsi32_si128 (dst));
+			dst = _mm_cvtsi128_si32 (out);
+			memcpy (p + i, &dst, 4);
+
+			vqx = _mm_add_ps (vqx, _mm_set1_ps (4.0f));
+		}
+	}
+#endif
+
+	/* what is left, or everything without simd */
+
+	for (; i < n; i++) {
+		qx = x + i + 0.5f - line->ax;
+
+		t = (qx * line->dx + qy * line->dy) * line->inv;
+		t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+
+		ex = qx - t * line->dx;
+		ey = qy - t * line->dy;
+
+		c = line->edge - sqrtf (ex * ex + ey * ey);
+		c = (c < 0.0f) ? 0.0f : (c > 1.0f) ? 1.0f : c;
+
+		level = (int) (c * line->level);
+
+		if (level > p[i]) {
+			p[i] = (unsigned char) level;
+		}
+	}
+}
+
+/* the rows of samples a line comes near */
+
+static void raster_yrange (const raster_line_t *line, int *y0, int *y1)
+{
+	float ymin, ymax, tmp;
+
+	ymin = line->ay;
+	ymax = line->ay + line->dy;
+
+	if (ymin > ymax) {
+		tmp = ymin;
+		ymin = ymax;
+		ymax = tmp;
+	}
+
+	*y0 = (int) floorf (ymin - line->edge);
+	*y1 = (int) ceilf (ymax + line->edge);
+}
+
+/* the columns of samples a line comes near between the heights ylo and
+ * yhi, which bound the samples within edge of a row or a row of tiles.
+ */
+
+static void raster_xrange (const raster_line_t *line, float ylo, float yhi,
+						   int *x0, int *x1)
+{
+	float t0, t1, xa, xb, tmp;
+
+	if (line->dy != 0.0f) {
+		t0 = (ylo - line->ay) / line->dy;
+		t1 = (yhi - line->ay) / line->dy;
+
+		if (t0 > t1) {
+			tmp = t0;
+			t0 = t1;
+			t1 = tmp;
+		}
+
+		t0 = (t0 < 0.0f) ? 0.0f : (t0 > 1.0f) ? 1.0f : t0;
+		t1 = (t1 < 0.0f) ? 0.0f : (t1 > 1.0f) ? 1.0f : t1;
+	} else {
+		t0 = 0.0f;
+		t1 = 1.0f;
+	}
+
+	xa = line->ax + t0 * line->dx;
+	xb = line->ax + t1 * line->dx;
+
+	if (xa > xb) {
+		tmp = xa;
+		xa = xb;
+		xb = tmp;
+	}
+
+	*x0 = (int) floorf (xa - line->edge);
+	*x1 = (int) ceilf (xb + line->edge);
+}
+
+/* draw the part of a line that falls in a tile. each row only gets the
+ * samples near where the line crosses it.
+ */
+
+static void raster_line (raster_t *r, const raster_line_t *line,
+						 const raster_tile_t *tile)
+{
+	float py;
+	int y, y0, y1, x0, x1, chunk;
+
+	chunk = RASTER_CHUNK * r->ss;
+
+	raster_yrange (line, &y0, &y1);
+
+	if (y0 < tile->y0) {
+		y0 = tile->y0;
+	}
+
+	if (y1 > tile->y1) {
+		y1 = tile->y1;
+	}
+
+	for (y = y0; y < y1; y++) {
+		py = y + 0.5f;
+
+		raster_xrange (line, py - line->edge, py + line->edge, &x0, &x1);
+
+		if (x0 < tile->x0) {
+			x0 = tile->x0;
+		}
+
+		if (x1 > tile->x1) {
+			x1 = tile->x1;
+		}
+
+		if (x1 > x0) {
+			raster_span (r->samples + (size_t) y * r->sw + x0, x0, x1 - x0,
+						 py - line->ay, line);
+
+			memset (r->dirty + (size_t) y * r->cw + x0 / chunk, 1,
+					(x1 - 1) / chunk - x0 / chunk + 1);
+		}
+	}
+}
+
+/* add line v to the bin of every tile it comes near, going by the part of
+ * the line in each row of tiles so that long diagonals stay in few bins.
+ */
+
+static void raster_bin (raster_t *r, const raster_line_t *line, long v)
+{
+	raster_tile_t *tile;
+	long *bin;
+	int y0, y1, x0, x1, tx, ty, tx0, tx1, ty0, ty1, ts;
+
+	ts = RASTER_TILE * r->ss;
+
+	raster_yrange (line, &y0, &y1);
+
+	if (y0 < 0) {
+		y0 = 0;
+	}
+
+	if (y1 > r->sh) {
+		y1 = r->sh;
+	}
+
+	if (y1 <= y0) {
+		return;
+	}
+
+	ty0 = y0 / ts;
+	ty1 = (y1 - 1) / ts;
+
+	for (ty = ty0; ty <= ty1; ty++) {
+		tile = r->tiles + ty * r->tw;
+
+		raster_xrange (line, tile->y0 + 0.5f - line->edge,
+					   tile->y1 - 0.5f + line->edge, &x0, &x1);
+
+		if (x0 < 0) {
+			x0 = 0;
+		}
+
+		if (x1 > r->sw) {
+			x1 = r->sw;
+		}
+
+		if (x1 <= x0) {
+			continue;
+		}
+
+		tx0 = x0 / ts;
+		tx1 = (x1 - 1) / ts;
+
+		for (tx = tx0; tx <= tx1; tx++) {
+			tile = r->tiles + ty * r->tw + tx;
+
+			if (tile->cnt == tile->cap) {
+				bin = realloc (tile->bin, sizeof (*bin) * (tile->cap ? tile->cap * 2 : 64));
+
+				if (bin == NULL) {
+					/* out of memory, the tile goes without the line */
+
+					continue;
+				}
+
+				tile->bin = bin;
+				tile->cap = tile->cap ? tile->cap * 2 : 64;
+			}
+
+			tile->bin[tile->cnt++] = v;
+		}
+	}
+}
+
+/* black out what the last frame drew in a tile */
+
+static void raster_clear (raster_t *r, const raster_tile_t *tile)
+{
+	unsigned char *dirty;
+	int y, c, c0, c1, chunk, n;
+
+	chunk = RASTER_CHUNK * r->ss;
+	c0 = tile->x0 / chunk;
+	c1 = (tile->x1 + chunk - 1) / chunk;
+
+	for (y = tile->y0; y < tile->y1; y++) {
+		dirty = r->dirty + (size_t) y * r->cw;
+
+		for (c = c0; c < c1; c++) {
+			if (dirty[c]) {
+				n = r->sw - c * chunk;
+
+				if (n > chunk) {
+					n = chunk;
+				}
+
+				memset (r->samples + (size_t) y * r->sw + c * chunk, 0, n);
+				dirty[c] = 0;
+			}
+		}
+	}
+}
+
+/* average each ss x ss block of samples in a tile into a pixel */
+
+static void raster_filter (raster_t *r, const raster_tile_t *tile)
+{
+	unsigned sum[RASTER_CHUNK];
+	const unsigned char *s;
+	unsigned char *d;
+	int y, c, c0, c1, i, j, k, n, ss, drawn;
+
+	ss = r->ss;
+	c0 = tile->x0 / ss / RASTER_CHUNK;
+	c1 = (tile->x1 / ss + RASTER_CHUNK - 1) / RASTER_CHUNK;
+
+	for (y = tile->y0 / ss; y < tile->y1 / ss; y++) {
+		for (c = c0; c < c1; c++) {
+			d = r->image + (size_t) y * r->width + c * RASTER_CHUNK;
+
+			n = r->width - c * RASTER_CHUNK;
+
+			if (n > RASTER_CHUNK) {
+				n = RASTER_CHUNK;
+			}
+
+			drawn = 0;
+
+			for (j = 0; j < ss; j++) {
+				drawn |= r->dirty[((size_t) y * ss + j) * r->cw + c];
+			}
+
+			if (!drawn) {
+				memset (d, 0, n);
+				continue;
+			}
+
+			memset (sum, 0, sizeof (sum));
+
+			for (j = 0; j < ss; j++) {
+				s = r->samples + ((size_t) y * ss + j) * r->sw +
+					(size_t) c * RASTER_CHUNK * ss;
+
+				for (i = 0; i < n; i++) {
+					for (k = 0; k < ss; k++) {
+						sum[i] += *s++;
+					}
+				}
+			}
+
+			for (i = 0; i < n; i++) {
+				d[i] = (unsigned char) (sum[i] / (ss * ss));
+			}
+		}
+	}
+}
+
+static void raster_tile (raster_t *r, const raster_tile_t *tile)
+{
+	long b;
+
+	raster_clear (r, tile);
+
+	for (b = 0; b < tile->cnt; b++) {
+		raster_line (r, r->lines + tile->bin[b], tile);
+	}
+
+	if (r->ss > 1) {
+		raster_filter (r, tile);
+	}
+}
+
+/* take tiles until there are none left, on whichever thread calls it */
+
+static void raster_work (raster_t *r, raster_pool_t *pool)
+{
+	long t, n;
+
+	n = (long) r->tw * r->th;
+
+	if (pool == NULL) {
+		for (t = 0; t < n; t++) {
+			raster_tile (r, r->tiles + t);
+		}
+
+		return;
+	}
+
+	while ((t = atomic_inc (&pool->next) - 1) < n) {
+		raster_tile (r, r->tiles + t);
+	}
+}
+
+#ifdef _WIN32
+
+static int raster_sem_init (raster_sem_t *sem)
+{
+	*sem = CreateSemaphore (NULL, 0, RASTER_THREADS_MAX * 2, NULL);
+
+	return *sem != NULL;
+}
+
+static void raster_sem_destroy (raster_sem_t *sem)
+{
+	CloseHandle (*sem);
+}
+
+static void raster_sem_post (raster_sem_t *sem)
+{
+	ReleaseSemaphore (*sem, 1, NULL);
+}
+
+static void raster_sem_wait (raster_sem_t *sem)
+{
+	WaitForSingleObject (*sem, INFINITE);
+}
+
+static DWORD WINAPI raster_worker (LPVOID arg);
+
+static int raster_thread_start (raster_thread_t *thread, raster_pool_t *pool)
+{
+	*thread = CreateThread (NULL, 0, raster_worker, pool, 0, NULL);
+
+	return *thread != NULL;
+}
+
+static void raster_thread_join (raster_thread_t *thread)
+{
+	WaitForSingleObject (*thread, INFINITE);
+	CloseHandle (*thread);
+}
+
+int raster_cpus (void)
+{
+	SYSTEM_INFO info;
+
+	GetSystemInfo (&info);
+
+	return (int) info.dwNumberOfProcessors;
+}
+
+#else
+
+static int raster_sem_init (raster_sem_t *sem)
+{
+	return sem_init (sem, 0, 0) == 0;
+}
+
+static void raster_sem_destroy (raster_sem_t *sem)
+{
+	sem_destroy (sem);
+}
+
+static void raster_sem_post (raster_sem_t *sem)
+{
+	sem_post (sem);
+}
+
+static void raster_sem_wait (raster_sem_t *sem)
+{
+	while (sem_wait (sem) != 0) {
+		/* interrupted by a signal */
+	}
+}
+
+static void *raster_worker (void *arg);
+
+static int raster_thread_start (raster_thread_t *thread, raster_pool_t *pool)
+{
+	return pthread_create (thread, NULL, raster_worker, pool) == 0;
+}
+
+static void raster_thread_join (raster_thread_t *thread)
+{
+	pthread_join (*thread, NULL);
+}
+
+int raster_cpus (void)
+{
+	long n;
+
+	n = sysconf (_SC_NPROCESSORS_ONLN);
+
+	return (n < 1) ? 1 : (n > RASTER_THREADS_MAX) ? RASTER_THREADS_MAX : (int) n;
+}
+
+#endif
+
+#ifdef _WIN32
+static DWORD WINAPI raster_worker (LPVOID arg)
+#else
+static void *raster_worker (void *arg)
+#endif
+{
+	raster_pool_t *pool;
+
+	pool = (raster_pool_t *) arg;
+
+	for (;;) {
+		raster_sem_wait (&pool->start);
+
+		if (atomic_load (&pool->quit)) {
+			break;
+		}
+
+		raster_work (pool->r, pool);
+		raster_sem_post (&pool->done);
+	}
+
+	return 0;
+}
+
+int raster_threads (raster_t *r, int n)
+{
+	raster_pool_t *pool;
+
+	if (n < 1) {
+		n = 1;
+	}
+
+	if (n > RASTER_THREADS_MAX) {
+		n = RASTER_THREADS_MAX;
+	}
+
+	if (n > 1 && r->pool == NULL) {
+		pool = calloc (1, sizeof (*pool));
+
+		if (pool == NULL) {
+			return r->threads;
+		}
+
+		if (!raster_sem_init (&pool->start)) {
+			free (pool);
+			return r->threads;
+		}
+
+		if (!raster_sem_init (&pool->done)) {
+			raster_sem_destroy (&pool->start);
+			free (pool);
+			return r->threads;
+		}
+
+		pool->r = r;
+		r->pool = pool;
+	}
+
+	pool = r->pool;
+
+	while (pool != NULL && pool->workers < n - 1) {
+		if (!raster_thread_start (&pool->thread[pool->workers], pool)) {
+			n = pool->workers + 1;
+			break;
+		}
+
+		pool->workers++;
+	}
+
+	r->threads = n;
+
+	return n;
+}
+
+static void raster_pool_stop (raster_t *r)
+{
+	raster_pool_t *pool;
+	int w;
+
+	pool = r->pool;
+
+	if (pool == NULL) {
+		return;
+	}
+
+	atomic_inc (&pool->quit);
+
+	for (w = 0; w < pool->workers; w++) {
+		raster_sem_post (&pool->start);
+	}
+
+	for (w = 0; w < pool->workers; w++) {
+		raster_thread_join (&pool->thread[w]);
+	}
+
+	raster_sem_destroy (&pool->start);
+	raster_sem_destroy (&pool->done);
+	free (pool);
+
+	r->pool = NULL;
+}
+
+/* draw a frame over a black image */
+
+void raster_frame (raster_t *r, const vecx_frame_t *frame)
+{
+	raster_line_t *lines;
+	raster_pool_t *pool;
+	long v, n;
+	int t, w;
+
+	if (frame->cnt > r->lines_cap) {
+		lines = realloc (r->lines, sizeof (*lines) * frame->cnt);
+
+		if (lines != NULL) {
+			r->lines = lines;
+			r->lines_cap = frame->cnt;
+		}
+	}
+
+	for (t = 0; t < r->tw * r->th; t++) {
+		r->tiles[t].cnt = 0;
+	}
+
+	/* out of memory for the lines leaves the frame black */
+
+	n = (frame->cnt <= r->lines_cap) ? frame->cnt : 0;
+
+	for (v = 0; v < n; v++) {
+		if (raster_setup (r, frame, v, r->lines + v)) {
+			raster_bin (r, r->lines + v, v);
+		}
+	}
+
+	pool = (r->threads > 1) ? r->pool : NULL;
+
+	if (pool == NULL) {
+		raster_work (r, NULL);
+		return;
+	}
+
+	/* the semaphores order these stores before the workers' loads */
+
+	pool->next = 0;
+
+	for (w = 0; w < r->threads - 1; w++) {
+		raster_sem_post (&pool->start);
+	}
+
+	raster_work (r, pool);
+
+	for (w = 0; w < r->threads - 1; w++) {
+		raster_sem_wait (&pool->done);
+	}
+}
@@ -0,0 +1,78 @@
+#ifndef __RASTER_H
+#define __RASTER_H
+
+#include "vecx.h"
+
+/* software vector renderer. it draws the vectors of a frame as
+ * anti-aliased lines of a given width into an 8-bit intensity image, each
+ * pixel taking the brightest line that covers it. lines are drawn at ss x ss
+ * samples per pixel and filtered down, and their coverage is computed
+ * exactly from the distance of each sample to the line, several samples at
+ * a time with sse2 or avx2 where the compiler targets them. a renderer
+ * shares nothing with others, so any number of them can run side by side.
+ *
+ * the image is cut into square tiles and every frame's lines are first
+ * sorted into the tiles they touch. tiles are then cleared, drawn and
+ * filtered on their own, by the calling thread alone or together with a
+ * pool of workers that take the next tile from an atomic counter. tiles
+ * own disjoint parts of the samples and the image, so nothing is locked
+ * and nothing is left to merge once the last tile is done.
+ */
+
+enum {
+	RASTER_SS_MAX		= 8,
+	RASTER_CHUNK		= 16,	/* pixels across, for keeping track of black areas */
+	RASTER_TILE			= 64,	/* pixels on a side, a multiple of RASTER_CHUNK */
+	RASTER_THREADS_MAX	= 64
+};
+
+struct raster_line;
+struct raster_tile;
+struct raster_pool;
+
+typedef struct raster {
+	int width;
+	int height;
+	int ss;				/* samples per pixel along each axis */
+	float line_width;	/* in pixels */
+
+	unsigned char *image;	/* width x height intensities, top row first */
+
+	/* private to raster.c */
+
+	int sw, sh;				/* size in samples */
+	unsigned char *samples;	/* sw x sh, the image itself if ss is 1 */
+
+	/* one flag for each RASTER_CHUNK pixels of each row of samples, set
+	 * if they may have been drawn on since they were last cleared. frames
+	 * are mostly black, so only those get cleared and filtered.
+	 */
+
+	int cw;					/* chunks across */
+	unsigned char *dirty;	/* sh x cw */
+
+	struct raster_line *lines;	/* of the frame being drawn */
+	long lines_cap;
+
+	int tw, th;					/* tiles across and down */
+	struct raster_tile *tiles;
+
+	int threads;				/* drawing a frame, the caller's included */
+	struct raster_pool *pool;	/* workers started so far */
+} raster_t;
+
+int raster_init (raster_t *r, int width, int height, int ss, float line_width);
+void raster_done (raster_t *r);
+
+/* draw with n threads from the next frame on. workers are started as
+ * needed and kept until raster_done, which makes changing n cheap. the
+ * raster_t must stay where it is while workers run. returns the number of
+ * threads that will be used, fewer than n if no more could be started.
+ */
+
+int raster_threads (raster_t *r, int n);
+int raster_cpus (void);
+
+void raster_frame (raster_t *r, const vecx_frame_t *frame);
+
+#endif
@@ -1,107 +1,25 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "e6809.h"
 #include "vecx.h"
-#include "osint.h"
 
 #define einline __inline
 
-unsigned char rom[8192];
-unsigned char cart[32768];
-static unsigned char ram[1024];
-
-/* the sound chip registers */
-
-unsigned snd_regs[16];
-static unsigned snd_select;
-
-/* the via 6522 registers */
-
-static unsigned via_ora;
-static unsigned via_orb;
-static unsigned via_ddra;
-static unsigned via_ddrb;
-static unsigned via_t1on;  /* is timer 1 on? */
-static unsigned via_t1int; /* are timer 1 interrupts allowed? */
-static unsigned via_t1c;
-static unsigned via_t1ll;
-static unsigned via_t1lh;
-static unsigned via_t1pb7; /* timer 1 controlled version of pb7 */
-static unsigned via_t2on;  /* is timer 2 on? */
-static unsigned via_t2int; /* are timer 2 interrupts allowed? */
-static unsigned via_t2c;
-static unsigned via_t2ll;
-static unsigned via_sr;
-static unsigned via_srb;   /* number of bits shifted so far */
-static unsigned via_src;   /* shift counter */
-static unsigned via_srclk;
-static unsigned via_acr;
-static unsigned via_pcr;
-static unsigned via_ifr;
-static unsigned via_ier;
-static unsigned via_ca2;
-static unsigned via_cb2h;  /* basic handshake version of cb2 */
-static unsigned via_cb2s;  /* version of cb2 controlled by the shift register */
-
-/* analog devices */
-
-static unsigned alg_rsh;  /* zero ref sample and hold */
-static unsigned alg_xsh;  /* x sample and hold */
-static unsigned alg_ysh;  /* y sample and hold */
-static unsigned alg_zsh;  /* z sample and hold */
-unsigned alg_jch0;		  /* joystick direction channel 0 */
-unsigned alg_jch1;		  /* joystick direction channel 1 */
-unsigned alg_jch2;		  /* joystick direction channel 2 */
-unsigned alg_jch3;		  /* joystick direction channel 3 */
-static unsigned alg_jsh;  /* joystick sample and hold */
-
-static unsigned alg_compare;
-
-static long alg_dx;     /* delta x */
-static long alg_dy;     /* delta y */
-static long alg_curr_x; /* current x position */
-static long alg_curr_y; /* current y position */
-
-enum {
-	VECTREX_PDECAY	= 30,      /* phosphor decay rate */
-	
-	/* number of 6809 cycles before a frame redraw */
-
-	FCYCLES_INIT    = VECTREX_MHZ / VECTREX_PDECAY,
-
-	/* max number of possible vectors that maybe on the screen at one time.
-	 * one only needs VECTREX_MHZ / VECTREX_PDECAY but we need to also store
-	 * deleted vectors in a single table
-	 */
-	
-	VECTOR_CNT		= VECTREX_MHZ / VECTREX_PDECAY,
-
-	VECTOR_HASH     = 65521
-};
-
-static unsigned alg_vectoring; /* are we drawing a vector right now? */
-static long alg_vector_x0;
-static long alg_vector_y0;
-static long alg_vector_x1;
-static long alg_vector_y1;
-static long alg_vector_dx;
-static long alg_vector_dy;
-static unsigned char alg_vector_color;
-
-long vector_draw_cnt;
-long vector_erse_cnt;
-static vector_t vectors_set[2 * VECTOR_CNT];
-vector_t *vectors_draw;
-vector_t *vectors_erse;
-
-static long vector_hash[VECTOR_HASH];
-
-static long fcycles;
-
 /* update the snd chips internal registers when via_ora/via_orb changes */
 
-static einline void snd_update (void)
+static einline void snd_update (vecx_t *vx)
 {
-	switch (via_orb & 0x18) {
+	switch (vx->via_orb & 0x18) {
 	case 0x00:
 		/* the sound chip is disabled */
 		break;
@@ -111,16 +29,16 @@ static einline void snd_update (void)
 	case 0x10:
 		/* the sound chip is recieving data */
 
-		if (snd_select != 14) {
-			snd_regs[snd_select] = via_ora;
+		if (vx->snd_select != 14) {
+			vx->snd_regs[vx->snd_select] = vx->via_ora;
 		}
 
 		break;
 	case 0x18:
 		/* the sound chip is latching an address */
 		
-		if ((via_ora & 0xf0) == 0x00) {
-			snd_select = via_ora & 0x0f;
+		if ((vx->via_ora & 0xf0) == 0x00) {
+			vx->snd_select = vx->via_ora & 0x0f;
 		}
 
 		break;
@@ -129,87 +47,104 @@ static einline void snd_update (void)
 
 /* update the various analog values when orb is written. */
 
-static einline void alg_update (void)
+static einline void alg_update (vecx_t *vx)
 {
-	switch (via_orb & 0x06) {
+	switch (vx->via_orb & 0x06) {
 	case 0x00:
-		alg_jsh = alg_jch0;
+		vx->alg_jsh = vx->alg_jch0;
 
-		if ((via_orb & 0x01) == 0x00) {
+		if ((vx->via_orb & 0x01) == 0x00) {
 			/* demultiplexor is on */
-			alg_ysh = alg_xsh;
+			vx->alg_ysh = vx->alg_xsh;
 		}
 
 		break;
 	case 0x02:
-		alg_jsh = alg_jch1;
+		vx->alg_jsh = vx->alg_jch1;
 
-		if ((via_orb & 0x01) == 0x00) {
+		if ((vx->via_orb & 0x01) == 0x00) {
 			/* demultiplexor is on */
-			alg_rsh = alg_xsh;
+			vx->alg_rsh = vx->alg_xsh;
 		}
 
 		break;
 	case 0x04:
-		alg_jsh = alg_jch2;
+		vx->alg_jsh = vx->alg_jch2;
 
-		if ((via_orb & 0x01) == 0x00) {
+		if ((vx->via_orb & 0x01) == 0x00) {
 			/* demultiplexor is on */
 
-			if (alg_xsh > 0x80) {
-				alg_zsh = alg_xsh - 0x80;
+			if (vx->alg_xsh > 0x80) {
+				vx->alg_zsh = vx->alg_xsh - 0x80;
 			} else {
-				alg_zsh = 0;
+				vx->alg_zsh = 0;
 			}
 		}
 
 		break;
 	case 0x06:
 		/* sound output line */
-		alg_jsh = alg_jch3;
+		vx->alg_jsh = vx->alg_jch3;
 		break;
 	}
 
 	/* compare the current joystick direction with a reference */
 
-	if (alg_jsh > alg_xsh) {
-		alg_compare = 0x20;
+	if (vx->alg_jsh > vx->alg_xsh) {
+		vx->alg_compare = 0x20;
 	} else {
-		alg_compare = 0;
+		vx->alg_compare = 0;
 	}
 
 	/* compute the new "deltas" */
 
-	alg_dx = (long) alg_xsh - (long) alg_rsh;
-	alg_dy = (long) alg_rsh - (long) alg_ysh;
+	vx->alg_dx = (long) vx->alg_xsh - (long) vx->alg_rsh;
+	vx->alg_dy = (long) vx->alg_rsh - (long) vx->alg_ysh;
 }
 
 /* update IRQ and bit-7 of the ifr register after making an adjustment to
  * ifr.
  */
 
-static einline void int_update (void)
+static einline void int_update (vecx_t *vx)
 {
-	if ((via_ifr & 0x7f) & (via_ier & 0x7f)) {
-		via_ifr |= 0x80;
+	if ((vx->via_ifr & 0x7f) & (vx->via_ier & 0x7f)) {
+		vx->via_ifr |= 0x80;
 	} else {
-		via_ifr &= 0x7f;
+		vx->via_ifr &= 0x7f;
+	}
+
+	vx->cpu.irq = vx->via_ifr & 0x80;
+}
+
+static einline unsigned char image_read (const vecx_image_t *img,
+										 unsigned address)
+{
+	if (img == NULL || address >= img->size) {
+		return 0;
 	}
+
+	return img->data[address];
 }
 
-unsigned char read8 (unsigned address)
+static unsigned char read8 (void *user, unsigned address)
 {
+	vecx_t *vx = (vecx_t *) user;
 	unsigned char data;
 
+	/* what anything not decoded below reads as */
+
+	data = 0xff;
+
 	if ((address & 0xe000) == 0xe000) {
 		/* rom */
 
-		data = rom[address & 0x1fff];
+		data = image_read (vx->rom, address & 0x1fff);
 	} else if ((address & 0xe000) == 0xc000) {
 		if (address & 0x800) {
 			/* ram */
 
-			data = ram[address & 0x3ff];
+			data = vx->ram[address & 0x3ff];
 		} else if (address & 0x1000) {
 			/* io */
 
@@ -219,297 +154,297 @@ unsigned char read8 (unsigned address)
 				 * via_orb.
 				 */
 
-				if (via_acr & 0x80) {
+				if (vx->via_acr & 0x80) {
 					/* timer 1 has control of bit 7 */
 
-					data = (unsigned char) ((via_orb & 0x5f) | via_t1pb7 | alg_compare);
+					data = (unsigned char) ((vx->via_orb & 0x5f) | vx->via_t1pb7 | vx->alg_compare);
 				} else {
 					/* bit 7 is being driven by via_orb */
 
-					data = (unsigned char) ((via_orb & 0xdf) | alg_compare);
+					data = (unsigned char) ((vx->via_orb & 0xdf) | vx->alg_compare);
 				}
 
 				break;
 			case 0x1:
 				/* register 1 also performs handshakes if necessary */
 
-				if ((via_pcr & 0x0e) == 0x08) {
+				if ((vx->via_pcr & 0x0e) == 0x08) {
 					/* if ca2 is in pulse mode or handshake mode, then it
 					 * goes low whenever ira is read.
 					 */
 
-					via_ca2 = 0;
+					vx->via_ca2 = 0;
 				}
 
 				/* fall through */
 
 			case 0xf:
-				if ((via_orb & 0x18) == 0x08) {
+				if ((vx->via_orb & 0x18) == 0x08) {
 					/* the snd chip is driving port a */
 
-					data = (unsigned char) snd_regs[snd_select];
+					data = (unsigned char) vx->snd_regs[vx->snd_select];
 				} else {
-					data = (unsigned char) via_ora;
+					data = (unsigned char) vx->via_ora;
 				}
 
 				break;
 			case 0x2:
-				data = (unsigned char) via_ddrb;
+				data = (unsigned char) vx->via_ddrb;
 				break;
 			case 0x3:
-				data = (unsigned char) via_ddra;
+				data = (unsigned char) vx->via_ddra;
 				break;
 			case 0x4:
 				/* T1 low order counter */
 				
-				data = (unsigned char) via_t1c;
-				via_ifr &= 0xbf; /* remove timer 1 interrupt flag */
+				data = (unsigned char) vx->via_t1c;
+				vx->via_ifr &= 0xbf; /* remove timer 1 interrupt flag */
 
-				via_t1on = 0; /* timer 1 is stopped */
-				via_t1int = 0;
-				via_t1pb7 = 0x80;
+				vx->via_t1on = 0; /* timer 1 is stopped */
+				vx->via_t1int = 0;
+				vx->via_t1pb7 = 0x80;
 
-				int_update ();
+				int_update (vx);
 
 				break;
 			case 0x5:
 				/* T1 high order counter */
 
-				data = (unsigned char) (via_t1c >> 8);
+				data = (unsigned char) (vx->via_t1c >> 8);
 
 				break;
 			case 0x6:
 				/* T1 low order latch */
 
-				data = (unsigned char) via_t1ll;
+				data = (unsigned char) vx->via_t1ll;
 				break;
 			case 0x7:
 				/* T1 high order latch */
 
-				data = (unsigned char) via_t1lh;
+				data = (unsigned char) vx->via_t1lh;
 				break;
 			case 0x8:
 				/* T2 low order counter */
 
-				data = (unsigned char) via_t2c;
-				via_ifr &= 0xdf; /* remove timer 2 interrupt flag */
+				data = (unsigned char) vx->via_t2c;
+				vx->via_ifr &= 0xdf; /* remove timer 2 interrupt flag */
 
-				via_t2on = 0; /* timer 2 is stopped */
-				via_t2int = 0;
+				vx->via_t2on = 0; /* timer 2 is stopped */
+				vx->via_t2int = 0;
 
-				int_update ();
+				int_update (vx);
 
 				break;
 			case 0x9:
 				/* T2 high order counter */
 
-				data = (unsigned char) (via_t2c >> 8);
+				data = (unsigned char) (vx->via_t2c >> 8);
 				break;
 			case 0xa:
-				data = (unsigned char) via_sr;
-				via_ifr &= 0xfb; /* remove shift register interrupt flag */
-				via_srb = 0;
-				via_srclk = 1;
+				data = (unsigned char) vx->via_sr;
+				vx->via_ifr &= 0xfb; /* remove shift register interrupt flag */
+				vx->via_srb = 0;
+				vx->via_srclk = 1;
 
-				int_update ();
+				int_update (vx);
 
 				break;
 			case 0xb:
-				data = (unsigned char) via_acr;
+				data = (unsigned char) vx->via_acr;
 				break;
 			case 0xc:
-				data = (unsigned char) via_pcr;
+				data = (unsigned char) vx->via_pcr;
 				break;
 			case 0xd:
 				/* interrupt flag register */
 
-				data = (unsigned char) via_ifr;
+				data = (unsigned char) vx->via_ifr;
 				break;
 			case 0xe:
 				/* interrupt enable register */
 
-				data = (unsigned char) (via_ier | 0x80);
+				data = (unsigned char) (vx->via_ier | 0x80);
 				break;
 			}
 		}
 	} else if (address < 0x8000) {
 		/* cartridge */
 
-		data = cart[address];
-	} else {
-		data = 0xff;
+		data = image_read (vx->cart, address);
 	}
 
 	return data;
 }
 
-void write8 (unsigned address, unsigned char data)
+static void write8 (void *user, unsigned address, unsigned char data)
 {
+	vecx_t *vx = (vecx_t *) user;
+
 	if ((address & 0xe000) == 0xe000) {
 		/* rom */
 	} else if ((address & 0xe000) == 0xc000) {
 		/* it is possible for both ram and io to be written at the same! */
 
 		if (address & 0x800) {
-			ram[address & 0x3ff] = data;
+			vx->ram[address & 0x3ff] = data;
 		}
 
 		if (address & 0x1000) {
 			switch (address & 0xf) {
 			case 0x0:
-				via_orb = data;
+				vx->via_orb = data;
 
-				snd_update ();
+				snd_update (vx);
 
-				alg_update ();
+				alg_update (vx);
 
-				if ((via_pcr & 0xe0) == 0x80) {
+				if ((vx->via_pcr & 0xe0) == 0x80) {
 					/* if cb2 is in pulse mode or handshake mode, then it
 					 * goes low whenever orb is written.
 					 */
 
-					via_cb2h = 0;
+					vx->via_cb2h = 0;
 				}
 
 				break;
 			case 0x1:
 				/* register 1 also performs handshakes if necessary */
 
-				if ((via_pcr & 0x0e) == 0x08) {
+				if ((vx->via_pcr & 0x0e) == 0x08) {
 					/* if ca2 is in pulse mode or handshake mode, then it
 					 * goes low whenever ora is written.
 					 */
 
-					via_ca2 = 0;
+					vx->via_ca2 = 0;
 				}
 
 				/* fall through */
 
 			case 0xf:
-				via_ora = data;
+				vx->via_ora = data;
 
-				snd_update ();
+				snd_update (vx);
 
 				/* output of port a feeds directly into the dac which then
 				 * feeds the x axis sample and hold.
 				 */
 
-				alg_xsh = data ^ 0x80;
+				vx->alg_xsh = data ^ 0x80;
 
-				alg_update ();
+				alg_update (vx);
 
 				break;
 			case 0x2:
-				via_ddrb = data;
+				vx->via_ddrb = data;
 				break;
 			case 0x3:
-				via_ddra = data;
+				vx->via_ddra = data;
 				break;
 			case 0x4:
 				/* T1 low order counter */
 				
-				via_t1ll = data;
+				vx->via_t1ll = data;
 
 				break;
 			case 0x5:
 				/* T1 high order counter */
 
-				via_t1lh = data;
-				via_t1c = (via_t1lh << 8) | via_t1ll;
-				via_ifr &= 0xbf; /* remove timer 1 interrupt flag */
+				vx->via_t1lh = data;
+				vx->via_t1c = (vx->via_t1lh << 8) | vx->via_t1ll;
+				vx->via_ifr &= 0xbf; /* remove timer 1 interrupt flag */
 
-				via_t1on = 1; /* timer 1 starts running */
-				via_t1int = 1;
-				via_t1pb7 = 0;
+				vx->via_t1on = 1; /* timer 1 starts running */
+				vx->via_t1int = 1;
+				vx->via_t1pb7 = 0;
 
-				int_update ();
+				int_update (vx);
 
 				break;
 			case 0x6:
 				/* T1 low order latch */
 
-				via_t1ll = data;
+				vx->via_t1ll = data;
 				break;
 			case 0x7:
 				/* T1 high order latch */
 
-				via_t1lh = data;
+				vx->via_t1lh = data;
 				break;
 			case 0x8:
 				/* T2 low order latch */
 
-				via_t2ll = data;
+				vx->via_t2ll = data;
 				break;
 			case 0x9:
 				/* T2 high order latch/counter */
 
-				via_t2c = (data << 8) | via_t2ll;
-				via_ifr &= 0xdf;
+				vx->via_t2c = (data << 8) | vx->via_t2ll;
+				vx->via_ifr &= 0xdf;
 
-				via_t2on = 1; /* timer 2 starts running */
-				via_t2int = 1;
+				vx->via_t2on = 1; /* timer 2 starts running */
+				vx->via_t2int = 1;
 
-				int_update ();
+				int_update (vx);
 
 				break;
 			case 0xa:
-				via_sr = data;
-				via_ifr &= 0xfb; /* remove shift register interrupt flag */
-				via_srb = 0;
-				via_srclk = 1;
+				vx->via_sr = data;
+				vx->via_ifr &= 0xfb; /* remove shift register interrupt flag */
+				vx->via_srb = 0;
+				vx->via_srclk = 1;
 
-				int_update ();
+				int_update (vx);
 
 				break;
 			case 0xb:
-				via_acr = data;
+				vx->via_acr = data;
 				break;
 			case 0xc:
-				via_pcr = data;
+				vx->via_pcr = data;
 
 
-				if ((via_pcr & 0x0e) == 0x0c) {
+				if ((vx->via_pcr & 0x0e) == 0x0c) {
 					/* ca2 is outputting low */
 
-					via_ca2 = 0;
+					vx->via_ca2 = 0;
 				} else {
 					/* ca2 is disabled or in pulse mode or is
 					 * outputting high.
 					 */
 
-					via_ca2 = 1;
+					vx->via_ca2 = 1;
 				}
 
-				if ((via_pcr & 0xe0) == 0xc0) {
+				if ((vx->via_pcr & 0xe0) == 0xc0) {
 					/* cb2 is outputting low */
 
-					via_cb2h = 0;
+					vx->via_cb2h = 0;
 				} else {
 					/* cb2 is disabled or is in pulse mode or is
 					 * outputting high.
 					 */
 
-					via_cb2h = 1;
+					vx->via_cb2h = 1;
 				}
 
 				break;
 			case 0xd:
 				/* interrupt flag register */
 
-				via_ifr &= ~(data & 0x7f);
-				int_update ();
+				vx->via_ifr &= ~(data & 0x7f);
+				int_update (vx);
 
 				break;
 			case 0xe:
 				/* interrupt enable register */
 
 				if (data & 0x80) {
-					via_ier |= data & 0x7f;
+					vx->via_ier |= data & 0x7f;
 				} else {
-					via_ier &= ~(data & 0x7f);
+					vx->via_ier &= ~(data & 0x7f);
 				}
 
-				int_update ();
+				int_update (vx);
 
 				break;
 			}
@@ -519,155 +454,662 @@ void write8 (unsigned address, unsigned char data)
 	}
 }
 
-void vecx_reset (void)
+/* map the first max bytes (or fewer) of a rom file. returns NULL if it
+ * cannot be read. the file must not change while it is mapped.
+ */
+
+vecx_image_t *vecx_image_map (const char *filename, unsigned long max)
+{
+	vecx_image_t *img;
+	unsigned long len, size;
+	void *map;
+#ifdef _WIN32
+	HANDLE file, mapping;
+	LARGE_INTEGER flen;
+
+	file = CreateFileA (filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+						OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		return NULL;
+	}
+
+	if (!GetFileSizeEx (file, &flen)) {
+		CloseHandle (file);
+		return NULL;
+	}
+
+	len = (unsigned long) flen.QuadPart;
+	size = len < max ? len : max;
+	map = NULL;
+
+	if (size > 0) {
+		mapping = CreateFileMappingA (file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+		if (mapping != NULL) {
+			map = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, size);
+			CloseHandle (mapping);
+		}
+	}
+
+	CloseHandle (file);
+#else
+	struct stat st;
+	int fd;
+
+	fd = open (filename, O_RDONLY);
+
+	if (fd < 0) {
+		return NULL;
+	}
+
+	if (fstat (fd, &st) != 0) {
+		close (fd);
+		return NULL;
+	}
+
+	len = (unsigned long) st.st_size;
+	size = len < max ? len : max;
+	map = NULL;
+
+	if (size > 0) {
+		map = mmap (NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+
+		if (map == MAP_FAILED) {
+			map = NULL;
+		}
+	}
+
+	close (fd);
+#endif
+
+	if (size > 0 && map == NULL) {
+		return NULL;
+	}
+
+	img = malloc (sizeof (*img));
+
+	if (img == NULL) {
+		if (map != NULL) {
+#ifdef _WIN32
+			UnmapViewOfFile (map);
+#else
+			munmap (map, size);
+#endif
+		}
+
+		return NULL;
+	}
+
+	/* a mapping of the whole file reads as zero from its end up to the end
+	 * of the last host page, which is at least a cpu page.
+	 */
+
+	img->data = (const unsigned char *) map;
+	img->size = size;
+	img->span = (size == len) ? (size + 0xff) & ~0xfful : size;
+	img->refs = 1;
+	img->map = map;
+	img->map_size = size;
+
+	return img;
+}
+
+/* an image of memory the caller keeps valid for as long as the image
+ * lives, such as the built-in bios.
+ */
+
+vecx_image_t *vecx_image_wrap (const unsigned char *data, unsigned long size)
+{
+	vecx_image_t *img;
+
+	img = malloc (sizeof (*img));
+
+	if (img == NULL) {
+		return NULL;
+	}
+
+	img->data = data;
+	img->size = size;
+	img->span = size;
+	img->refs = 1;
+	img->map = NULL;
+	img->map_size = 0;
+
+	return img;
+}
+
+/* images may be shared by instances on different threads, so references
+ * are counted atomically. the last release unmaps the file.
+ */
+
+void vecx_image_retain (vecx_image_t *img)
+{
+	atomic_inc (&img->refs);
+}
+
+void vecx_image_release (vecx_image_t *img)
+{
+	if (atomic_dec (&img->refs) != 0) {
+		return;
+	}
+
+	if (img->map != NULL) {
+#ifdef _WIN32
+		UnmapViewOfFile (img->map);
+#else
+		munmap (img->map, img->map_size);
+#endif
+	}
+
+	free (img);
+}
+
+/* the cpu page backing page p of an image. pages past the end of the image
+ * read as zero, a page it ends inside of goes through read8 unless the
+ * rest of that page is readable.
+ */
+
+static const unsigned char *image_page (const vecx_image_t *img, unsigned p)
+{
+	static const unsigned char page_00[256];
+
+	if (img == NULL || (unsigned long) p << 8 >= img->size) {
+		return page_00;
+	}
+
+	if (((unsigned long) p + 1) << 8 > img->span) {
+		return NULL;
+	}
+
+	return img->data + (p << 8);
+}
+
+/* fill in the cpu memory map. the cartridge, ram and rom are accessed
+ * directly, only the io pages (and ram mirrors that also hit io on a
+ * write) are left to read8 and write8.
+ */
+
+static void map_init (vecx_t *vx)
+{
+	unsigned p;
+
+	memset (vx->page_ff, 0xff, sizeof (vx->page_ff));
+
+	for (p = 0; p < 256; p++) {
+		if (p >= 0xe0) {
+			/* rom */
+
+			vx->cpu.rmap[p] = image_page (vx->rom, p & 0x1f);
+			vx->cpu.wmap[p] = vx->page_wo;
+		} else if (p >= 0xc0) {
+			vx->cpu.rmap[p] = NULL;
+			vx->cpu.wmap[p] = NULL;
+
+			if (p & 0x08) {
+				/* ram, mirrored every 1k. reads of the pages which also
+				 * select io return ram.
+				 */
+
+				vx->cpu.rmap[p] = vx->ram + ((p & 0x03) << 8);
+
+				if ((p & 0x10) == 0) {
+					vx->cpu.wmap[p] = vx->ram + ((p & 0x03) << 8);
+				}
+			} else if ((p & 0x10) == 0) {
+				/* neither ram nor io selected */
+
+				vx->cpu.wmap[p] = vx->page_wo;
+			}
+		} else if (p >= 0x80) {
+			/* unmapped */
+
+			vx->cpu.rmap[p] = vx->page_ff;
+			vx->cpu.wmap[p] = vx->page_wo;
+		} else {
+			/* cartridge */
+
+			vx->cpu.rmap[p] = image_page (vx->cart, p);
+			vx->cpu.wmap[p] = vx->page_wo;
+		}
+	}
+}
+
+/* plug in the bios or cartridge image, which takes effect at the next
+ * vecx_reset. the instance holds a reference to it until it is replaced or
+ * vecx_done is called.
+ */
+
+void vecx_set_rom (vecx_t *vx, vecx_image_t *img)
+{
+	if (img != NULL) {
+		vecx_image_retain (img);
+	}
+
+	if (vx->rom != NULL) {
+		vecx_image_release (vx->rom);
+	}
+
+	vx->rom = img;
+}
+
+void vecx_set_cart (vecx_t *vx, vecx_image_t *img)
+{
+	if (img != NULL) {
+		vecx_image_retain (img);
+	}
+
+	if (vx->cart != NULL) {
+		vecx_image_release (vx->cart);
+	}
+
+	vx->cart = img;
+}
+
+static void cpu_sync (void *user, unsigned cycles);
+static unsigned cpu_idle (void *user, unsigned cycles, unsigned n,
+						  const unsigned *addr, const unsigned char *data);
+static unsigned cpu_hle (void *user, unsigned cycles);
+static int hle_stock (vecx_t *vx);
+
+/* point vectors_draw at the list of frame_draw. the emulator has the only
+ * reference to the frame it draws into, so it may write the list that
+ * consumers later see read-only.
+ */
+
+static void vlist_draw (vecx_t *vx)
+{
+	vx->vectors_draw.x0 = (unsigned short *) vx->frame_draw->x0;
+	vx->vectors_draw.y0 = (unsigned short *) vx->frame_draw->y0;
+	vx->vectors_draw.x1 = (unsigned short *) vx->frame_draw->x1;
+	vx->vectors_draw.y1 = (unsigned short *) vx->frame_draw->y1;
+	vx->vectors_draw.color = (unsigned char *) vx->frame_draw->color;
+}
+
+/* fibonacci hash of the packed end points of a vector, bits wide */
+
+static einline unsigned vector_bucket (long x0, long y0, long x1, long y1,
+									   unsigned bits)
+{
+	unsigned long long key;
+
+	key = (unsigned long long) x0 | (unsigned long long) y0 << 16 |
+		  (unsigned long long) x1 << 32 | (unsigned long long) y1 << 48;
+
+	return (unsigned) ((key * 0x9e3779b97f4a7c15ull) >> (64 - bits));
+}
+
+/* the first free slot in the probe run from bucket h, NULL if there is
+ * none.
+ */
+
+static einline vecx_vslot_t *vslot_free (vecx_t *vx, unsigned h)
+{
+	vecx_vslot_t *slot;
+	unsigned mask, p;
+
+	mask = (1u << vx->vector_hash_bits) - 1;
+
+	for (p = 0; p < VECTOR_PROBE; p++) {
+		slot = vx->vector_hash + ((h + p) & mask);
+
+		if (slot->gen != vx->vector_gen) {
+			return slot;
+		}
+	}
+
+	return NULL;
+}
+
+/* make the dedupe table big enough for a draw list of cap vectors and put
+ * the lines already drawn into the new one. if there is no memory for it
+ * the old table stays, with longer probe runs.
+ */
+
+static void vslot_grow (vecx_t *vx, long cap)
+{
+	vecx_vslot_t *hash, *old, *slot;
+	unsigned bits, h;
+	long i;
+
+	for (bits = 1; (1l << bits) < cap * VECTOR_HASH_LOAD; bits++) {
+	}
+
+	if (vx->vector_hash != NULL && bits <= vx->vector_hash_bits) {
+		return;
+	}
+
+	hash = calloc ((size_t) 1 << bits, sizeof (*hash));
+
+	if (hash == NULL) {
+		return;
+	}
+
+	old = vx->vector_hash;
+	vx->vector_hash = hash;
+	vx->vector_hash_bits = bits;
+	free (old);
+
+	for (i = 0; i < vx->vector_draw_cnt; i++) {
+		h = vector_bucket (vx->vectors_draw.x0[i], vx->vectors_draw.y0[i],
+						   vx->vectors_draw.x1[i], vx->vectors_draw.y1[i], bits);
+		slot = vslot_free (vx, h);
+
+		if (slot != NULL) {
+			slot->gen = vx->vector_gen;
+			slot->index = (unsigned) i;
+		}
+	}
+}
+
+/* make room for more vectors in the list of frame_draw. all five arrays of
+ * a list share one block, which doubles in size each time it fills up.
+ * returns 0 if the list is at VECTOR_CNT already or out of memory.
+ */
+
+static int vlist_grow (vecx_t *vx)
+{
+	vecx_frame_t *f;
+	unsigned short *x0, *y0, *x1, *y1;
+	unsigned char *color;
+	size_t cnt;
+	long cap;
+
+	f = vx->frame_draw;
+
+	if (f->cap >= VECTOR_CNT) {
+		return 0;
+	}
+
+	cap = (f->cap > 0) ? f->cap * 2 : VECTOR_MIN;
+
+	if (cap > VECTOR_CNT) {
+		cap = VECTOR_CNT;
+	}
+
+	x0 = malloc ((size_t) cap * (4 * sizeof (*x0) + sizeof (*color)));
+
+	if (x0 == NULL) {
+		return 0;
+	}
+
+	y0 = x0 + cap;
+	x1 = y0 + cap;
+	y1 = x1 + cap;
+	color = (unsigned char *) (y1 + cap);
+
+	cnt = (size_t) vx->vector_draw_cnt;
+
+	if (cnt > 0) {
+		memcpy (x0, f->x0, cnt * sizeof (*x0));
+		memcpy (y0, f->y0, cnt * sizeof (*y0));
+		memcpy (x1, f->x1, cnt * sizeof (*x1));
+		memcpy (y1, f->y1, cnt * sizeof (*y1));
+		memcpy (color, f->color, cnt * sizeof (*color));
+	}
+
+	free ((void *) f->x0);
+
+	vx->vector_bytes += (unsigned long) (cap - f->cap) *
+						(4 * sizeof (*x0) + sizeof (*color));
+
+	f->x0 = x0;
+	f->y0 = y0;
+	f->x1 = x1;
+	f->y1 = y1;
+	f->color = color;
+	f->cap = cap;
+
+	vlist_draw (vx);
+	vslot_grow (vx, cap);
+
+	return 1;
+}
+
+/* empty the dedupe table for a new draw list. only when the generation
+ * wraps around do the slots need clearing.
+ */
+
+static void vslot_clear (vecx_t *vx)
+{
+	if (++vx->vector_gen == 0) {
+		if (vx->vector_hash != NULL) {
+			memset (vx->vector_hash, 0,
+					((size_t) 1 << vx->vector_hash_bits) * sizeof (*vx->vector_hash));
+		}
+
+		vx->vector_gen = 1;
+	}
+}
+
+void vecx_reset (vecx_t *vx)
 {
 	unsigned r;
 
 	/* ram */
 
 	for (r = 0; r < 1024; r++) {
-		ram[r] = r & 0xff;
+		vx->ram[r] = r & 0xff;
 	}
 
 	for (r = 0; r < 16; r++) {
-		snd_regs[r] = 0;
+		vx->snd_regs[r] = 0;
 	}
 
 	/* input buttons */
 
-	snd_regs[14] = 0xff;
-
-	snd_select = 0;
-
-	via_ora = 0;
-	via_orb = 0;
-	via_ddra = 0;
-	via_ddrb = 0;
-	via_t1on = 0;
-	via_t1int = 0;
-	via_t1c = 0;
-	via_t1ll = 0;
-	via_t1lh = 0;
-	via_t1pb7 = 0x80;
-	via_t2on = 0;
-	via_t2int = 0; 
-	via_t2c = 0;
-	via_t2ll = 0;
-	via_sr = 0;
-	via_srb = 8;
-	via_src = 0;
-	via_srclk = 0;
-	via_acr = 0;
-	via_pcr = 0;
-	via_ifr = 0;
-	via_ier = 0;
-	via_ca2 = 1;
-	via_cb2h = 1;
-	via_cb2s = 0;
-
-	alg_rsh = 128;
-	alg_xsh = 128;
-	alg_ysh = 128;
-	alg_zsh = 0;
-	alg_jch0 = 128;
-	alg_jch1 = 128;
-	alg_jch2 = 128;
-	alg_jch3 = 128;
-	alg_jsh = 128;
-
-	alg_compare = 0; /* check this */
-
-	alg_dx = 0;
-	alg_dy = 0;
-	alg_curr_x = ALG_MAX_X / 2;
-	alg_curr_y = ALG_MAX_Y / 2;
-
-	alg_vectoring = 0;
-
-	vector_draw_cnt = 0;
-	vector_erse_cnt = 0;
-	vectors_draw = vectors_set;
-	vectors_erse = vectors_set + VECTOR_CNT;
+	vx->snd_regs[14] = 0xff;
+
+	vx->snd_select = 0;
+
+	vx->via_ora = 0;
+	vx->via_orb = 0;
+	vx->via_ddra = 0;
+	vx->via_ddrb = 0;
+	vx->via_t1on = 0;
+	vx->via_t1int = 0;
+	vx->via_t1c = 0;
+	vx->via_t1ll = 0;
+	vx->via_t1lh = 0;
+	vx->via_t1pb7 = 0x80;
+	vx->via_t2on = 0;
+	vx->via_t2int = 0; 
+	vx->via_t2c = 0;
+	vx->via_t2ll = 0;
+	vx->via_sr = 0;
+	vx->via_srb = 8;
+	vx->via_src = 0;
+	vx->via_srclk = 0;
+	vx->via_acr = 0;
+	vx->via_pcr = 0;
+	vx->via_ifr = 0;
+	vx->via_ier = 0;
+	vx->via_ca2 = 1;
+	vx->via_cb2h = 1;
+	vx->via_cb2s = 0;
+
+	vx->alg_rsh = 128;
+	vx->alg_xsh = 128;
+	vx->alg_ysh = 128;
+	vx->alg_zsh = 0;
+	vx->alg_jch0 = 128;
+	vx->alg_jch1 = 128;
+	vx->alg_jch2 = 128;
+	vx->alg_jch3 = 128;
+	vx->alg_jsh = 128;
+
+	vx->alg_compare = 0; /* check this */
+
+	vx->alg_dx = 0;
+	vx->alg_dy = 0;
+	vx->alg_curr_x = ALG_MAX_X / 2;
+	vx->alg_curr_y = ALG_MAX_Y / 2;
+
+	vx->alg_vectoring = 0;
+
+	/* frames still held by a consumer survive the reset, and all frames
+	 * keep the lists they have grown. frame_end never hands out the frame
+	 * being drawn into, so that one is kept. the first reset takes a free
+	 * frame, and if a consumer holds them all the oldest is drawn over
+	 * rather than having none.
+	 */
+
+	if (vx->frame_draw == NULL) {
+		for (r = 0; r < FRAME_CNT; r++) {
+			if (atomic_load (&vx->frames[r].refs) == 0) {
+				vx->frame_draw = vx->frames + r;
+				break;
+			}
+		}
+	}
+
+	if (vx->frame_draw == NULL) {
+		vx->frame_draw = vx->frames;
+
+		for (r = 1; r < FRAME_CNT; r++) {
+			if (vx->frames[r].number < vx->frame_draw->number) {
+				vx->frame_draw = vx->frames + r;
+			}
+		}
+	}
+
+	vx->frame_number = 0;
+	vx->frames_dropped = 0;
+
+	vx->vector_draw_cnt = 0;
+	vlist_draw (vx);
+	vslot_clear (vx);
+	vslot_grow (vx, (vx->frame_draw->cap > VECTOR_MIN) ? vx->frame_draw->cap : VECTOR_MIN);
+
+	vx->vector_lines = 0;
+	vx->vector_dedups = 0;
+	vx->vector_spills = 0;
+	vx->vector_drops = 0;
+	vx->vector_peak = 0;
 	
-	fcycles = FCYCLES_INIT;
+	vx->fcycles = FCYCLES_INIT;
+	vx->emu_over = 0;
+
+	vx->hle_calls = 0;
+	vx->hle_stalls = 0;
+
+	vx->cpu.read8 = read8;
+	vx->cpu.write8 = write8;
+	vx->cpu.sync = cpu_sync;
+	vx->cpu.idle = cpu_idle;
+	vx->cpu.hle = NULL;
+	vx->cpu.user = vx;
+	vx->cpu.irq = 0;
+	vx->cpu.firq = 0;
+
+	map_init (vx);
+	e6809_reset (&vx->cpu);
+
+	for (r = 0; r < vx->idle_pc_cnt && r < IDLE_PC_CNT; r++) {
+		e6809_idle_pc (&vx->cpu, vx->idle_pc[r]);
+	}
+
+	if (vx->hle_enable && !vx->lockstep && hle_stock (vx)) {
+		vx->cpu.hle = cpu_hle;
+		e6809_hle_pc (&vx->cpu, 0xf312); /* moveto_d */
+		e6809_hle_pc (&vx->cpu, 0xf37a); /* print_str_d */
+		e6809_hle_pc (&vx->cpu, 0xf3ce); /* draw_vlc */
+		e6809_hle_pc (&vx->cpu, 0xf46e); /* draw_vl_mode */
+	}
+}
+
+void vecx_done (vecx_t *vx)
+{
+	unsigned f;
+
+	e6809_done (&vx->cpu);
+	vecx_set_rom (vx, NULL);
+	vecx_set_cart (vx, NULL);
 
-	e6809_read8 = read8;
-	e6809_write8 = write8;
+	for (f = 0; f < FRAME_CNT; f++) {
+		free ((void *) vx->frames[f].x0);
+		memset (vx->frames + f, 0, sizeof (vx->frames[f]));
+	}
+
+	vx->frame_draw = NULL;
+	vx->vector_bytes = 0;
 
-	e6809_reset ();
+	free (vx->vector_hash);
+	vx->vector_hash = NULL;
+	vx->vector_hash_bits = 0;
 }
 
 /* perform a single cycle worth of via emulation.
  * via_sstep0 is the first postion of the emulation.
  */
 
-static einline void via_sstep0 (void)
+static einline void via_sstep0 (vecx_t *vx)
 {
 	unsigned t2shift;
 
-	if (via_t1on) {
-		via_t1c--;
+	if (vx->via_t1on) {
+		vx->via_t1c--;
 
-		if ((via_t1c & 0xffff) == 0xffff) {
+		if ((vx->via_t1c & 0xffff) == 0xffff) {
 			/* counter just rolled over */
 
-			if (via_acr & 0x40) {
+			if (vx->via_acr & 0x40) {
 				/* continuous interrupt mode */
 
-				via_ifr |= 0x40;
-				int_update ();
-				via_t1pb7 = 0x80 - via_t1pb7;
+				vx->via_ifr |= 0x40;
+				int_update (vx);
+				vx->via_t1pb7 = 0x80 - vx->via_t1pb7;
 
 				/* reload counter */
 
-				via_t1c = (via_t1lh << 8) | via_t1ll;
+				vx->via_t1c = (vx->via_t1lh << 8) | vx->via_t1ll;
 			} else {
 				/* one shot mode */
 
-				if (via_t1int) {
-					via_ifr |= 0x40;
-					int_update ();
-					via_t1pb7 = 0x80;
-					via_t1int = 0;
+				if (vx->via_t1int) {
+					vx->via_ifr |= 0x40;
+					int_update (vx);
+					vx->via_t1pb7 = 0x80;
+					vx->via_t1int = 0;
 				}
 			}
 		}
 	}
 
-	if (via_t2on && (via_acr & 0x20) == 0x00) {
-		via_t2c--;
+	if (vx->via_t2on && (vx->via_acr & 0x20) == 0x00) {
+		vx->via_t2c--;
 
-		if ((via_t2c & 0xffff) == 0xffff) {
+		if ((vx->via_t2c & 0xffff) == 0xffff) {
 			/* one shot mode */
 
-			if (via_t2int) {
-				via_ifr |= 0x20;
-				int_update ();
-				via_t2int = 0;
+			if (vx->via_t2int) {
+				vx->via_ifr |= 0x20;
+				int_update (vx);
+				vx->via_t2int = 0;
 			}
 		}
 	}
 
 	/* shift counter */
 
-	via_src--;
+	vx->via_src--;
 
-	if ((via_src & 0xff) == 0xff) {
-		via_src = via_t2ll;
+	if ((vx->via_src & 0xff) == 0xff) {
+		vx->via_src = vx->via_t2ll;
 
-		if (via_srclk) {
+		if (vx->via_srclk) {
 			t2shift = 1;
-			via_srclk = 0;
+			vx->via_srclk = 0;
 		} else {
 			t2shift = 0;
-			via_srclk = 1;
+			vx->via_srclk = 1;
 		}
 	} else {
 		t2shift = 0;
 	}
 
-	if (via_srb < 8) {
-		switch (via_acr & 0x1c) {
+	if (vx->via_srb < 8) {
+		switch (vx->via_acr & 0x1c) {
 		case 0x00:
 			/* disabled */
 			break;
@@ -677,16 +1119,16 @@ static einline void via_sstep0 (void)
 			if (t2shift) {
 				/* shifting in 0s since cb2 is always an output */
 
-				via_sr <<= 1;
-				via_srb++;
+				vx->via_sr <<= 1;
+				vx->via_srb++;
 			}
 
 			break;
 		case 0x08:
 			/* shift in under system clk control */
 
-			via_sr <<= 1;
-			via_srb++;
+			vx->via_sr <<= 1;
+			vx->via_srb++;
 
 			break;
 		case 0x0c:
@@ -696,10 +1138,10 @@ static einline void via_sstep0 (void)
 			/* shift out under t2 control (free run) */
 
 			if (t2shift) {
-				via_cb2s = (via_sr >> 7) & 1;
+				vx->via_cb2s = (vx->via_sr >> 7) & 1;
 
-				via_sr <<= 1;
-				via_sr |= via_cb2s;
+				vx->via_sr <<= 1;
+				vx->via_sr |= vx->via_cb2s;
 			}
 
 			break;
@@ -707,22 +1149,22 @@ static einline void via_sstep0 (void)
 			/* shift out under t2 control */
 
 			if (t2shift) {
-				via_cb2s = (via_sr >> 7) & 1;
+				vx->via_cb2s = (vx->via_sr >> 7) & 1;
 
-				via_sr <<= 1;
-				via_sr |= via_cb2s;
-				via_srb++;
+				vx->via_sr <<= 1;
+				vx->via_sr |= vx->via_cb2s;
+				vx->via_srb++;
 			}
 
 			break;
 		case 0x18:
 			/* shift out under system clock control */
 
-			via_cb2s = (via_sr >> 7) & 1;
+			vx->via_cb2s = (vx->via_sr >> 7) & 1;
 
-			via_sr <<= 1;
-			via_sr |= via_cb2s;
-			via_srb++;
+			vx->via_sr <<= 1;
+			vx->via_sr |= vx->via_cb2s;
+			vx->via_srb++;
 
 			break;
 		case 0x1c:
@@ -730,132 +1172,245 @@ static einline void via_sstep0 (void)
 			break;
 		}
 
-		if (via_srb == 8) {
-			via_ifr |= 0x04;
-			int_update ();
+		if (vx->via_srb == 8) {
+			vx->via_ifr |= 0x04;
+			int_update (vx);
 		}
 	}
 }
 
-/* perform the second part of the via emulation */
+/* number of cycles up to and including the next cycle in which the via
+ * does more than count down: a timer rollover that raises an interrupt or
+ * reloads timer 1, or a shift of the shift register. ~0 if there is none.
+ * only the sources in the interrupt mask 'sources' (ier bits) are looked
+ * at.
+ */
 
-static einline void via_sstep1 (void)
+static unsigned via_next (vecx_t *vx, unsigned sources)
 {
-	if ((via_pcr & 0x0e) == 0x0a) {
-		/* if ca2 is in pulse mode, then make sure
-		 * it gets restored to '1' after the pulse.
-		 */
+	unsigned d, n;
+
+	d = ~0u;
 
-		via_ca2 = 1;
+	if ((sources & 0x40) && vx->via_t1on && ((vx->via_acr & 0x40) || vx->via_t1int)) {
+		n = (vx->via_t1c & 0xffff) + 1;
+		d = (n < d) ? n : d;
 	}
 
-	if ((via_pcr & 0xe0) == 0xa0) {
-		/* if cb2 is in pulse mode, then make sure
-		 * it gets restored to '1' after the pulse.
-		 */
+	if ((sources & 0x20) && vx->via_t2on && (vx->via_acr & 0x20) == 0x00 && vx->via_t2int) {
+		n = (vx->via_t2c & 0xffff) + 1;
+		d = (n < d) ? n : d;
+	}
 
-		via_cb2h = 1;
+	if ((sources & 0x04) && vx->via_srb < 8) {
+		switch (vx->via_acr & 0x1c) {
+		case 0x08:
+		case 0x18:
+			/* shifting under system clock control */
+			d = 1;
+			break;
+		case 0x04:
+		case 0x10:
+		case 0x14:
+			/* shifting under t2 control */
+			n = (vx->via_src & 0xff) + 1;
+			d = (n < d) ? n : d;
+			break;
+		}
 	}
+
+	return d;
 }
 
-static einline void alg_addline (long x0, long y0, long x1, long y1, unsigned char color)
+/* advance the via by n cycles, none of which may contain an event as
+ * defined by via_next. equivalent to n calls of via_sstep0.
+ */
+
+static void via_skip (vecx_t *vx, unsigned n)
 {
-	unsigned long key;
-	long index;
+	unsigned first, period;
 
-	key = (unsigned long) x0;
-	key = key * 31 + (unsigned long) y0;
-	key = key * 31 + (unsigned long) x1;
-	key = key * 31 + (unsigned long) y1;
-	key %= VECTOR_HASH;
+	if (vx->via_t1on) {
+		vx->via_t1c -= n;
+	}
 
-	/* first check if the line to be drawn is in the current draw list.
-	 * if it is, then it is not added again.
+	if (vx->via_t2on && (vx->via_acr & 0x20) == 0x00) {
+		vx->via_t2c -= n;
+	}
+
+	/* the shift counter reloads from the t2 low latch every time it rolls
+	 * over, and the shift clock toggles.
 	 */
 
-	index = vector_hash[key];
+	first = (vx->via_src & 0xff) + 1;
 
-	if (index >= 0 && index < vector_draw_cnt &&
-		x0 == vectors_draw[index].x0 &&
-		y0 == vectors_draw[index].y0 &&
-		x1 == vectors_draw[index].x1 &&
-		y1 == vectors_draw[index].y1) {
-		vectors_draw[index].color = color;
+	if (n < first) {
+		vx->via_src -= n;
 	} else {
-		/* missed on the draw list, now check if the line to be drawn is in
-		 * the erase list ... if it is, "invalidate" it on the erase list.
-		 */
-
-		if (index >= 0 && index < vector_erse_cnt &&
-			x0 == vectors_erse[index].x0 &&
-			y0 == vectors_erse[index].y0 &&
-			x1 == vectors_erse[index].x1 &&
-			y1 == vectors_erse[index].y1) {
-			vectors_erse[index].color = VECTREX_COLORS;
-		}
+		n -= first;
+		period = vx->via_t2ll + 1;
 
-		vectors_draw[vector_draw_cnt].x0 = x0;
-		vectors_draw[vector_draw_cnt].y0 = y0;
-		vectors_draw[vector_draw_cnt].x1 = x1;
-		vectors_draw[vector_draw_cnt].y1 = y1;
-		vectors_draw[vector_draw_cnt].color = color;
-		vector_hash[key] = vector_draw_cnt;
-		vector_draw_cnt++;
+		vx->via_src = vx->via_t2ll - n % period;
+		vx->via_srclk ^= (1 + n / period) & 1;
 	}
 }
 
-/* perform a single cycle worth of analog emulation */
+/* perform the second part of the via emulation */
 
-static einline void alg_sstep (void)
+static einline void via_sstep1 (vecx_t *vx)
 {
-	long sig_dx, sig_dy;
-	unsigned sig_ramp;
-	unsigned sig_blank;
+	if ((vx->via_pcr & 0x0e) == 0x0a) {
+		/* if ca2 is in pulse mode, then make sure
+		 * it gets restored to '1' after the pulse.
+		 */
+
+		vx->via_ca2 = 1;
+	}
+
+	if ((vx->via_pcr & 0xe0) == 0xa0) {
+		/* if cb2 is in pulse mode, then make sure
+		 * it gets restored to '1' after the pulse.
+		 */
+
+		vx->via_cb2h = 1;
+	}
+}
+
+static einline void alg_addline (vecx_t *vx, long x0, long y0, long x1, long y1, unsigned char color)
+{
+	vecx_vlist_t *v;
+	vecx_vslot_t *slot;
+	unsigned h, mask, p;
+	long index;
+
+	v = &vx->vectors_draw;
+	vx->vector_lines++;
+
+	slot = NULL;
+
+	/* first check if the line to be drawn is in the current draw list.
+	 * if it is, then it is not added again.
+	 */
+
+	if (vx->vector_hash != NULL) {
+		h = vector_bucket (x0, y0, x1, y1, vx->vector_hash_bits);
+		mask = (1u << vx->vector_hash_bits) - 1;
+
+		for (p = 0; p < VECTOR_PROBE; p++) {
+			slot = vx->vector_hash + ((h + p) & mask);
+
+			if (slot->gen != vx->vector_gen) {
+				/* free, so the line is not in the list */
+
+				break;
+			}
+
+			index = slot->index;
+			slot = NULL;
+
+			if (x0 == v->x0[index] && y0 == v->y0[index] &&
+				x1 == v->x1[index] && y1 == v->y1[index]) {
+				v->color[index] = color;
+				vx->vector_dedups++;
+				return;
+			}
+		}
+	}
+
+	index = vx->vector_draw_cnt;
+
+	if (index >= vx->frame_draw->cap) {
+		if (!vlist_grow (vx)) {
+			vx->vector_drops++;
+			return;
+		}
+
+		/* the table may have grown with the list */
+
+		if (vx->vector_hash != NULL) {
+			slot = vslot_free (vx, vector_bucket (x0, y0, x1, y1,
+												  vx->vector_hash_bits));
+		}
+	}
+
+	if (slot != NULL) {
+		slot->gen = vx->vector_gen;
+		slot->index = (unsigned) index;
+	} else {
+		vx->vector_spills++;
+	}
+
+	vx->vector_draw_cnt++;
+
+	v->x0[index] = (unsigned short) x0;
+	v->y0[index] = (unsigned short) y0;
+	v->x1[index] = (unsigned short) x1;
+	v->y1[index] = (unsigned short) y1;
+	v->color[index] = color;
+}
+
+/* the blanking signal and the distance the beam moves in the current
+ * cycle.
+ */
 
-	if ((via_acr & 0x10) == 0x10) {
-		sig_blank = via_cb2s;
+static einline void alg_signals (vecx_t *vx, long *sig_dx, long *sig_dy, unsigned *sig_blank)
+{
+	unsigned sig_ramp;
+
+	if ((vx->via_acr & 0x10) == 0x10) {
+		*sig_blank = vx->via_cb2s;
 	} else {
-		sig_blank = via_cb2h;
+		*sig_blank = vx->via_cb2h;
 	}
 
-	if (via_ca2 == 0) {
+	if (vx->via_ca2 == 0) {
 		/* need to force the current point to the 'orgin' so just
 		 * calculate distance to origin and use that as dx,dy.
 		 */
 
-		sig_dx = ALG_MAX_X / 2 - alg_curr_x;
-		sig_dy = ALG_MAX_Y / 2 - alg_curr_y;
+		*sig_dx = ALG_MAX_X / 2 - vx->alg_curr_x;
+		*sig_dy = ALG_MAX_Y / 2 - vx->alg_curr_y;
 	} else {
-		if (via_acr & 0x80) {
-			sig_ramp = via_t1pb7;
+		if (vx->via_acr & 0x80) {
+			sig_ramp = vx->via_t1pb7;
 		} else {
-			sig_ramp = via_orb & 0x80;
+			sig_ramp = vx->via_orb & 0x80;
 		}
 
 		if (sig_ramp == 0) {
-			sig_dx = alg_dx;
-			sig_dy = alg_dy;
+			*sig_dx = vx->alg_dx;
+			*sig_dy = vx->alg_dy;
 		} else {
-			sig_dx = 0;
-			sig_dy = 0;
+			*sig_dx = 0;
+			*sig_dy = 0;
 		}
 	}
+}
+
+/* perform a single cycle worth of analog emulation */
+
+static einline void alg_sstep (vecx_t *vx)
+{
+	long sig_dx, sig_dy;
+	unsigned sig_blank;
 
-	if (alg_vectoring == 0) {
+	alg_signals (vx, &sig_dx, &sig_dy, &sig_blank);
+
+	if (vx->alg_vectoring == 0) {
 		if (sig_blank == 1 &&
-			alg_curr_x >= 0 && alg_curr_x < ALG_MAX_X &&
-			alg_curr_y >= 0 && alg_curr_y < ALG_MAX_Y) {
+			vx->alg_curr_x >= 0 && vx->alg_curr_x < ALG_MAX_X &&
+			vx->alg_curr_y >= 0 && vx->alg_curr_y < ALG_MAX_Y) {
 
 			/* start a new vector */
 
-			alg_vectoring = 1;
-			alg_vector_x0 = alg_curr_x;
-			alg_vector_y0 = alg_curr_y;
-			alg_vector_x1 = alg_curr_x;
-			alg_vector_y1 = alg_curr_y;
-			alg_vector_dx = sig_dx;
-			alg_vector_dy = sig_dy;
-			alg_vector_color = (unsigned char) alg_zsh;
+			vx->alg_vectoring = 1;
+			vx->alg_vector_x0 = vx->alg_curr_x;
+			vx->alg_vector_y0 = vx->alg_curr_y;
+			vx->alg_vector_x1 = vx->alg_curr_x;
+			vx->alg_vector_y1 = vx->alg_curr_y;
+			vx->alg_vector_dx = sig_dx;
+			vx->alg_vector_dy = sig_dy;
+			vx->alg_vector_color = (unsigned char) vx->alg_zsh;
 		}
 	} else {
 		/* already drawing a vector ... check if we need to turn it off */
@@ -865,91 +1420,1562 @@ static einline void alg_sstep (void)
 			 * new line.
 			 */
 
-			alg_vectoring = 0;
+			vx->alg_vectoring = 0;
 
-			alg_addline (alg_vector_x0, alg_vector_y0,
-						 alg_vector_x1, alg_vector_y1,
-						 alg_vector_color);
-		} else if (sig_dx != alg_vector_dx ||
-				   sig_dy != alg_vector_dy ||
-				   (unsigned char) alg_zsh != alg_vector_color) {
+			alg_addline (vx, vx->alg_vector_x0, vx->alg_vector_y0,
+						 vx->alg_vector_x1, vx->alg_vector_y1,
+						 vx->alg_vector_color);
+		} else if (sig_dx != vx->alg_vector_dx ||
+				   sig_dy != vx->alg_vector_dy ||
+				   (unsigned char) vx->alg_zsh != vx->alg_vector_color) {
 
 			/* the parameters of the vectoring processing has changed.
 			 * so end the current line.
 			 */
 
-			alg_addline (alg_vector_x0, alg_vector_y0,
-						 alg_vector_x1, alg_vector_y1,
-						 alg_vector_color);
+			alg_addline (vx, vx->alg_vector_x0, vx->alg_vector_y0,
+						 vx->alg_vector_x1, vx->alg_vector_y1,
+						 vx->alg_vector_color);
 
 			/* we continue vectoring with a new set of parameters if the
 			 * current point is not out of limits.
 			 */
 
-			if (alg_curr_x >= 0 && alg_curr_x < ALG_MAX_X &&
-				alg_curr_y >= 0 && alg_curr_y < ALG_MAX_Y) {
-				alg_vector_x0 = alg_curr_x;
-				alg_vector_y0 = alg_curr_y;
-				alg_vector_x1 = alg_curr_x;
-				alg_vector_y1 = alg_curr_y;
-				alg_vector_dx = sig_dx;
-				alg_vector_dy = sig_dy;
-				alg_vector_color = (unsigned char) alg_zsh;
+			if (vx->alg_curr_x >= 0 && vx->alg_curr_x < ALG_MAX_X &&
+				vx->alg_curr_y >= 0 && vx->alg_curr_y < ALG_MAX_Y) {
+				vx->alg_vector_x0 = vx->alg_curr_x;
+				vx->alg_vector_y0 = vx->alg_curr_y;
+				vx->alg_vector_x1 = vx->alg_curr_x;
+				vx->alg_vector_y1 = vx->alg_curr_y;
+				vx->alg_vector_dx = sig_dx;
+				vx->alg_vector_dy = sig_dy;
+				vx->alg_vector_color = (unsigned char) vx->alg_zsh;
 			} else {
-				alg_vectoring = 0;
+				vx->alg_vectoring = 0;
 			}
 		}
 	}
 
-	alg_curr_x += sig_dx;
-	alg_curr_y += sig_dy;
+	vx->alg_curr_x += sig_dx;
+	vx->alg_curr_y += sig_dy;
 
-	if (alg_vectoring == 1 &&
-		alg_curr_x >= 0 && alg_curr_x < ALG_MAX_X &&
-		alg_curr_y >= 0 && alg_curr_y < ALG_MAX_Y) {
+	if (vx->alg_vectoring == 1 &&
+		vx->alg_curr_x >= 0 && vx->alg_curr_x < ALG_MAX_X &&
+		vx->alg_curr_y >= 0 && vx->alg_curr_y < ALG_MAX_Y) {
 
 		/* we're vectoring ... current point is still within limits so
 		 * extend the current vector.
 		 */
 
-		alg_vector_x1 = alg_curr_x;
-		alg_vector_y1 = alg_curr_y;
+		vx->alg_vector_x1 = vx->alg_curr_x;
+		vx->alg_vector_y1 = vx->alg_curr_y;
 	}
 }
 
-void vecx_emu (long cycles, int ahead)
+/* the steps j >= 0 for which 0 <= p + j * d < max, as the range [*lo, *hi].
+ * returns 0 if there are none.
+ */
+
+static int alg_span (long p, long d, long max, long *lo, long *hi)
 {
-	unsigned c, icycles;
+	if (d < 0) {
+		/* mirror so the position increases */
 
-	while (cycles > 0) {
-		icycles = e6809_sstep (via_ifr & 0x80, 0);
+		p = max - 1 - p;
+		d = -d;
+	}
+
+	if (p >= max) {
+		return 0;
+	}
 
-		for (c = 0; c < icycles; c++) {
-			via_sstep0 ();
-			alg_sstep ();
-			via_sstep1 ();
+	if (d == 0) {
+		if (p < 0) {
+			return 0;
 		}
 
-		cycles -= (long) icycles;
+		*lo = 0;
+		*hi = LONG_MAX;
+	} else {
+		*lo = (p >= 0) ? 0 : (-p + d - 1) / d;
+		*hi = (max - 1 - p) / d;
+	}
+
+	return *lo <= *hi;
+}
+
+/* the steps j >= 0 at which the beam is inside the visible window if it
+ * keeps moving by (dx, dy) every cycle.
+ */
+
+static int alg_window (vecx_t *vx, long dx, long dy, long *lo, long *hi)
+{
+	long xlo, xhi, ylo, yhi;
+
+	if (!alg_span (vx->alg_curr_x, dx, ALG_MAX_X, &xlo, &xhi) ||
+		!alg_span (vx->alg_curr_y, dy, ALG_MAX_Y, &ylo, &yhi)) {
+		return 0;
+	}
+
+	*lo = (xlo > ylo) ? xlo : ylo;
+	*hi = (xhi < yhi) ? xhi : yhi;
+
+	return *lo <= *hi;
+}
+
+/* perform n cycles of analog emulation during which none of the signals
+ * feeding the analog hardware change. equivalent to n calls of alg_sstep.
+ *
+ * once the beam moves at a constant rate and the vector being drawn (if
+ * any) has the current parameters, nothing changes but the beam position
+ * and the end point of the vector. the only other thing that can happen is
+ * that a vector starts when the beam enters the window. both are worked out
+ * from where the beam path crosses the window.
+ */
+
+static void alg_run (vecx_t *vx, unsigned n)
+{
+	long sig_dx, sig_dy;
+	unsigned sig_blank;
+	long lo, hi, j;
+
+	while (n > 0) {
+		alg_signals (vx, &sig_dx, &sig_dy, &sig_blank);
 
-		fcycles -= (long) icycles;
+		if (vx->via_ca2 == 0 && (sig_dx != 0 || sig_dy != 0)) {
+			/* still moving to the origin */
+		} else if (vx->alg_vectoring == 0) {
+			if (sig_blank == 0 || !alg_window (vx, sig_dx, sig_dy, &lo, &hi) ||
+				lo >= (long) n) {
+				/* no vector starts within the n cycles */
 
-		if (fcycles < 0) {
-			vector_t *tmp;
+				vx->alg_curr_x += sig_dx * (long) n;
+				vx->alg_curr_y += sig_dy * (long) n;
+
+				return;
+			}
 
-			fcycles += FCYCLES_INIT;
-			osint_render ();
+			/* move up to the cycle in which the vector starts */
 
-			/* everything that was drawn during this pass now now enters
-			 * the erase list for the next pass.
+			vx->alg_curr_x += sig_dx * lo;
+			vx->alg_curr_y += sig_dy * lo;
+			n -= (unsigned) lo;
+		} else if (sig_blank == 1 &&
+				   sig_dx == vx->alg_vector_dx && sig_dy == vx->alg_vector_dy &&
+				   (unsigned char) vx->alg_zsh == vx->alg_vector_color) {
+			/* extending the current vector. its end point is the last
+			 * position within the window.
 			 */
 
-			vector_erse_cnt = vector_draw_cnt;
-			vector_draw_cnt = 0;
+			if (alg_window (vx, sig_dx, sig_dy, &lo, &hi) && hi >= 1 &&
+				lo <= (long) n) {
+				j = (hi < (long) n) ? hi : (long) n;
+
+				vx->alg_vector_x1 = vx->alg_curr_x + sig_dx * j;
+				vx->alg_vector_y1 = vx->alg_curr_y + sig_dy * j;
+			}
+
+			vx->alg_curr_x += sig_dx * (long) n;
+			vx->alg_curr_y += sig_dy * (long) n;
+
+			return;
+		}
+
+		alg_sstep (vx);
+		n--;
+	}
+}
+
+/* register the function that receives finished frames. the consumer owns
+ * one reference to each frame it is handed and must give it back with
+ * vecx_frame_release once it is done with the vector list, which need not
+ * happen inside the callback.
+ */
+
+void vecx_frame_callback (vecx_t *vx, vecx_frame_fn fn, void *user)
+{
+	vx->frame_fn = fn;
+	vx->frame_user = user;
+}
+
+/* references may be dropped from another thread, so they are counted
+ * atomically.
+ */
+
+void vecx_frame_retain (vecx_frame_t *frame)
+{
+	atomic_inc (&frame->refs);
+}
+
+void vecx_frame_release (vecx_frame_t *frame)
+{
+	atomic_dec (&frame->refs);
+}
+
+unsigned long vecx_frames_dropped (vecx_t *vx)
+{
+	return vx->frames_dropped;
+}
+
+/* called from the emulation thread with a frame it owns a reference to.
+ * a frame the render thread never picked up is released here.
+ */
+
+void vecx_tribuf_publish (vecx_tribuf_t *tb, vecx_frame_t *frame)
+{
+	vecx_frame_t *old;
+
+	old = (vecx_frame_t *) atomic_xchg_ptr (&tb->middle, (void *) frame);
+
+	if (old != NULL) {
+		vecx_frame_release (old);
+	}
+}
+
+/* called from the render thread. returns the newest frame published since
+ * the last call, or NULL if there is none. the caller owns the returned
+ * reference.
+ */
+
+vecx_frame_t *vecx_tribuf_acquire (vecx_tribuf_t *tb)
+{
+	return (vecx_frame_t *) atomic_xchg_ptr (&tb->middle, NULL);
+}
+
+/* live vector sets. slots are found by their end points through an open
+ * addressing table with linear probing, at most half full so runs stay
+ * short.
+ */
+
+static void live_dirty (vecx_live_t *live, long s)
+{
+	if (live->dirty_lo >= live->dirty_hi) {
+		live->dirty_lo = s;
+		live->dirty_hi = s + 1;
+	} else if (s < live->dirty_lo) {
+		live->dirty_lo = s;
+	} else if (s >= live->dirty_hi) {
+		live->dirty_hi = s + 1;
+	}
+}
+
+static unsigned live_home (vecx_live_t *live, long s)
+{
+	return vector_bucket (live->x0[s], live->y0[s], live->x1[s], live->y1[s],
+						  live->map_bits);
+}
+
+/* table index of the slot holding the vector, or of the empty entry where
+ * it would go.
+ */
+
+static unsigned live_find (vecx_live_t *live, unsigned x0, unsigned y0,
+						   unsigned x1, unsigned y1)
+{
+	unsigned mask, i;
+	long s;
+
+	mask = (1u << live->map_bits) - 1;
+	i = vector_bucket (x0, y0, x1, y1, live->map_bits);
+
+	while (live->map[i] != 0) {
+		s = live->map[i] - 1;
+
+		if (live->x0[s] == x0 && live->y0[s] == y0 &&
+			live->x1[s] == x1 && live->y1[s] == y1) {
+			break;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	return i;
+}
+
+/* take out entry i, moving later entries of the run back into the gap so
+ * no lookup is cut short.
+ */
+
+static void live_unmap (vecx_live_t *live, unsigned i)
+{
+	unsigned mask, j, k;
+
+	mask = (1u << live->map_bits) - 1;
+	j = i;
+
+	for (;;) {
+		j = (j + 1) & mask;
+
+		if (live->map[j] == 0) {
+			break;
+		}
+
+		k = live_home (live, live->map[j] - 1);
+
+		/* an entry whose home lies cyclically in (i, j] stays */
+
+		if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+			continue;
+		}
+
+		live->map[i] = live->map[j];
+		i = j;
+	}
+
+	live->map[i] = 0;
+}
+
+static int live_realloc (void *pp, size_t n, size_t size)
+{
+	void *p;
+
+	p = realloc (*(void **) pp, n * size);
+
+	if (p == NULL) {
+		return 0;
+	}
+
+	*(void **) pp = p;
+
+	return 1;
+}
+
+/* double the room for slots, up to VECTOR_CNT, and rebuild the table at
+ * twice that. returns 0 if there is no more room.
+ */
+
+static int live_grow (vecx_live_t *live)
+{
+	unsigned *map;
+	unsigned bits;
+	long cap, s;
+
+	if (live->cap >= VECTOR_CNT) {
+		return 0;
+	}
+
+	cap = (live->cap > 0) ? live->cap * 2 : VECTOR_MIN;
+
+	if (cap > VECTOR_CNT) {
+		cap = VECTOR_CNT;
+	}
+
+	for (bits = 1; (1l << bits) < cap * 2; bits++) {
+	}
+
+	if (!live_realloc (&live->x0, cap, sizeof (*live->x0)) ||
+		!live_realloc (&live->y0, cap, sizeof (*live->y0)) ||
+		!live_realloc (&live->x1, cap, sizeof (*live->x1)) ||
+		!live_realloc (&live->y1, cap, sizeof (*live->y1)) ||
+		!live_realloc (&live->color, cap, sizeof (*live->color)) ||
+		!live_realloc (&live->seen, cap, sizeof (*live->seen)) ||
+		!live_realloc (&live->free_slot, cap, sizeof (*live->free_slot))) {
+		return 0;
+	}
+
+	map = calloc ((size_t) 1 << bits, sizeof (*map));
+
+	if (map == NULL) {
+		return 0;
+	}
+
+	free (live->map);
+	live->map = map;
+	live->map_bits = bits;
+	live->cap = cap;
+
+	for (s = 0; s < live->cnt; s++) {
+		if (live->seen[s] != 0) {
+			live->map[live_find (live, live->x0[s], live->y0[s],
+								 live->x1[s], live->y1[s])] = (unsigned) s + 1;
+		}
+	}
 
-			tmp = vectors_erse;
-			vectors_erse = vectors_draw;
-			vectors_draw = tmp;
+	return 1;
+}
+
+/* bring the set in line with a frame and return the number of slots that
+ * changed. vectors that do not fit in VECTOR_CNT slots or in memory are
+ * left out.
+ */
+
+long vecx_live_update (vecx_live_t *live, const vecx_frame_t *frame)
+{
+	unsigned i;
+	long v, s, t, n;
+
+	if (live->cap == 0 && !live_grow (live)) {
+		return 0;
+	}
+
+	if (frame->cnt > live->pend_cap) {
+		if (!live_realloc (&live->pend, frame->cnt, sizeof (*live->pend))) {
+			return 0;
+		}
+
+		live->pend_cap = frame->cnt;
+	}
+
+	if (++live->gen == 0) {
+		for (s = 0; s < live->cnt; s++) {
+			if (live->seen[s] != 0) {
+				live->seen[s] = 1;
+			}
+		}
+
+		live->gen = 2;
+	}
+
+	live->added = 0;
+	live->removed = 0;
+	live->recolored = 0;
+
+	/* vectors already on screen */
+
+	n = 0;
+
+	for (v = 0; v < frame->cnt; v++) {
+		i = live_find (live, frame->x0[v], frame->y0[v], frame->x1[v], frame->y1[v]);
+
+		if (live->map[i] == 0) {
+			live->pend[n++] = v;
+			continue;
+		}
+
+		s = live->map[i] - 1;
+		live->seen[s] = live->gen;
+
+		if (live->color[s] != frame->color[v]) {
+			live->color[s] = frame->color[v];
+			live_dirty (live, s);
+			live->recolored++;
+		}
+	}
+
+	/* vectors gone from the screen */
+
+	for (s = 0; s < live->cnt; s++) {
+		if (live->seen[s] == 0 || live->seen[s] == live->gen) {
+			continue;
+		}
+
+		live_unmap (live, live_find (live, live->x0[s], live->y0[s],
+									 live->x1[s], live->y1[s]));
+
+		live->x0[s] = VECTOR_PARKED;
+		live->y0[s] = VECTOR_PARKED;
+		live->x1[s] = VECTOR_PARKED;
+		live->y1[s] = VECTOR_PARKED;
+		live->seen[s] = 0;
+		live->free_slot[live->free_cnt++] = s;
+		live->live--;
+		live->removed++;
+		live_dirty (live, s);
+	}
+
+	/* new vectors, in the order they were drawn */
+
+	for (v = 0; v < n; v++) {
+		s = live->pend[v];
+
+		if (live->free_cnt == 0 && live->cnt == live->cap && !live_grow (live)) {
+			break;
+		}
+
+		i = live_find (live, frame->x0[s], frame->y0[s], frame->x1[s], frame->y1[s]);
+
+		if (live->map[i] != 0) {
+			/* drawn twice in the frame */
+
+			t = live->map[i] - 1;
+			live->color[t] = frame->color[s];
+			live_dirty (live, t);
+			continue;
 		}
+
+		t = (live->free_cnt > 0) ? live->free_slot[--live->free_cnt] : live->cnt++;
+		live->map[i] = (unsigned) t + 1;
+
+		live->x0[t] = frame->x0[s];
+		live->y0[t] = frame->y0[s];
+		live->x1[t] = frame->x1[s];
+		live->y1[t] = frame->y1[s];
+		live->color[t] = frame->color[s];
+		live->seen[t] = live->gen;
+		live->live++;
+		live->added++;
+		live_dirty (live, t);
+	}
+
+	return live->added + live->removed + live->recolored;
+}
+
+/* the consumer has caught up with every change so far */
+
+void vecx_live_clean (vecx_live_t *live)
+{
+	live->dirty_lo = 0;
+	live->dirty_hi = 0;
+}
+
+void vecx_live_done (vecx_live_t *live)
+{
+	free (live->x0);
+	free (live->y0);
+	free (live->x1);
+	free (live->y1);
+	free (live->color);
+	free (live->seen);
+	free (live->free_slot);
+	free (live->pend);
+	free (live->map);
+
+	memset (live, 0, sizeof (*live));
+}
+
+/* hand the frame that was just drawn to the consumer and pick a free buffer
+ * to draw the next one into. if the consumer is still holding every other
+ * buffer the finished frame is dropped and its buffer reused.
+ */
+
+static void frame_end (vecx_t *vx)
+{
+	vecx_frame_t *next;
+	unsigned f;
+
+	vx->frame_draw->cnt = vx->vector_draw_cnt;
+	vx->frame_draw->number = vx->frame_number++;
+
+	if (vx->vector_draw_cnt > vx->vector_peak) {
+		vx->vector_peak = vx->vector_draw_cnt;
 	}
+
+	next = NULL;
+
+	if (vx->frame_fn != NULL) {
+		for (f = 0; f < FRAME_CNT; f++) {
+			if (vx->frames + f != vx->frame_draw && atomic_load (&vx->frames[f].refs) == 0) {
+				next = vx->frames + f;
+				break;
+			}
+		}
+
+		if (next != NULL) {
+			atomic_inc (&vx->frame_draw->refs);
+			(*vx->frame_fn) (vx->frame_draw, vx->frame_user);
+		} else {
+			vx->frames_dropped++;
+		}
+	}
+
+	if (next != NULL) {
+		vx->frame_draw = next;
+	}
+
+	vlist_draw (vx);
+	vx->vector_draw_cnt = 0;
+	vslot_clear (vx);
+}
+
+/* n cycles of via and analog emulation without a via event */
+
+static void hw_quiet (vecx_t *vx, unsigned n)
+{
+	if (n > 0) {
+		via_skip (vx, n);
+
+		/* via_sstep1 can only change anything in the first cycle, after
+		 * that the analog inputs stay put.
+		 */
+
+		alg_sstep (vx);
+		via_sstep1 (vx);
+		alg_run (vx, n - 1);
+	}
+}
+
+/* advance the via and analog hardware by n cycles. the via only does real
+ * work in cycles with an event and the analog hardware only when one of
+ * its inputs changes, everything in between is advanced in closed form.
+ */
+
+static void hw_run (vecx_t *vx, unsigned n)
+{
+	unsigned d;
+
+	while (n > 0) {
+		d = via_next (vx, 0x7f);
+
+		if (d > n) {
+			hw_quiet (vx, n);
+			break;
+		}
+
+		hw_quiet (vx, d - 1);
+
+		via_sstep0 (vx);
+		alg_sstep (vx);
+		via_sstep1 (vx);
+
+		n -= d;
+	}
+}
+
+/* called by the cpu core before it accesses io, so the via and analog
+ * hardware are where they would be had they been stepped after every
+ * instruction.
+ */
+
+static void cpu_sync (void *user, unsigned cycles)
+{
+	vecx_t *vx = (vecx_t *) user;
+
+	if (cycles > vx->sync_cycles) {
+		hw_run (vx, cycles - vx->sync_cycles);
+		vx->sync_cycles = cycles;
+	}
+}
+
+/* called by the cpu core when it spins in a loop polling io. registers
+ * whose reads have side effects or return a running counter rule it out,
+ * everything else only changes on a write or at a via event.
+ */
+
+static unsigned cpu_idle (void *user, unsigned cycles, unsigned n,
+						  const unsigned *addr, const unsigned char *data)
+{
+	vecx_t *vx = (vecx_t *) user;
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		if ((addr[i] & 0xf800) != 0xd000) {
+			return 0;
+		}
+
+		switch (addr[i] & 0xf) {
+		case 0x1:
+		case 0x4:
+		case 0x5:
+		case 0x8:
+		case 0x9:
+		case 0xa:
+			return 0;
+		}
+	}
+
+	cpu_sync (vx, cycles);
+
+	for (i = 0; i < n; i++) {
+		if (read8 (vx, addr[i]) != data[i]) {
+			return 0;
+		}
+	}
+
+	return via_next (vx, 0x7f);
+}
+
+/* high level emulation of the bios routines that draw vectors and text.
+ * each routine below retraces the bios code instruction by instruction: it
+ * makes the same memory and via accesses at the same cycles and leaves the
+ * same registers, flags and stack contents behind, but without decoding
+ * anything. the via and analog hardware are brought along through cpu_sync
+ * as usual, so they see exactly what the cpu would have shown them. only
+ * the stock bios is handled, anything else runs on the cpu.
+ */
+
+enum {
+	HLE_C			= 0x01,
+	HLE_V			= 0x02,
+	HLE_Z			= 0x04,
+	HLE_N			= 0x08,
+	HLE_I			= 0x10,
+	HLE_H			= 0x20,
+	HLE_F			= 0x40,
+	HLE_ARITH		= HLE_H | HLE_N | HLE_Z | HLE_V | HLE_C
+};
+
+#define HLE_BIOS_HASH 0x8ed592e8ul /* fnv-1a of the stock bios */
+
+#define HLE_IO(r) (0xd000 | (r)) /* direct page access, dp is $d0 */
+
+/* an instruction of n cycles has finished. the frame ends after the
+ * instruction that crosses into the next one, as in vecx_emu.
+ */
+
+static void hle_op (vecx_t *vx, unsigned n)
+{
+	vx->hle_t += n;
+
+	if ((long) (vx->hle_base + vx->hle_t) > vx->fcycles) {
+		cpu_sync (vx, vx->hle_base + vx->hle_t);
+		vx->fcycles += FCYCLES_INIT;
+		frame_end (vx);
+	}
+}
+
+/* memory accesses happen at the start of the instruction, io ones with the
+ * hardware caught up to there.
+ */
+
+static unsigned hle_read (vecx_t *vx, unsigned address)
+{
+	address &= 0xffff;
+
+	if ((address & 0xf000) == 0xd000) {
+		cpu_sync (vx, vx->hle_base + vx->hle_t);
+	}
+
+	return read8 (vx, address);
+}
+
+static void hle_write (vecx_t *vx, unsigned address, unsigned data)
+{
+	address &= 0xffff;
+
+	if ((address & 0xf000) == 0xd000) {
+		cpu_sync (vx, vx->hle_base + vx->hle_t);
+	}
+
+	write8 (vx, address, (unsigned char) data);
+}
+
+static void hle_push8 (vecx_t *vx, unsigned data)
+{
+	vx->hle.s = (vx->hle.s - 1) & 0xffff;
+	hle_write (vx, vx->hle.s, data);
+}
+
+static unsigned hle_pull8 (vecx_t *vx)
+{
+	unsigned data;
+
+	data = hle_read (vx, vx->hle.s);
+	vx->hle.s = (vx->hle.s + 1) & 0xffff;
+
+	return data;
+}
+
+/* flags the way the cpu core computes them. i0 and i1 are the inputs to
+ * the adder (i1 already complemented for a subtract) and r its output,
+ * shift is 8 for 16-bit operations.
+ */
+
+static void hle_flags (vecx_t *vx, unsigned mask, unsigned sub, unsigned i0, unsigned i1,
+					   unsigned r, unsigned shift)
+{
+	unsigned c, v, cc;
+
+	c = ((i0 | i1) & ~r) | (i0 & i1); /* carry out of each bit */
+	v = ~(i0 ^ i1) & (i0 ^ r);
+	cc = 0;
+
+	cc |= ((c >> 3) & 1) * HLE_H;
+	cc |= ((r >> (7 + shift)) & 1) * HLE_N;
+	cc |= ((r & ((0x100 << shift) - 1)) == 0) * HLE_Z;
+	cc |= ((v >> (7 + shift)) & 1) * HLE_V;
+	cc |= (((c >> (7 + shift)) & 1) ^ sub) * HLE_C;
+
+	vx->hle.cc = (vx->hle.cc & ~mask) | (cc & mask);
+}
+
+/* n and z from a load, store or test, v cleared */
+
+static void hle_nz (vecx_t *vx, unsigned r, unsigned shift)
+{
+	hle_flags (vx, HLE_N | HLE_Z | HLE_V, 0, 0, 0, r, shift);
+}
+
+static unsigned hle_dec8 (vecx_t *vx, unsigned data)
+{
+	hle_flags (vx, HLE_N | HLE_Z | HLE_V, 0, data, 0xff, data + 0xff, 0);
+
+	return (data - 1) & 0xff;
+}
+
+static unsigned hle_sub8 (vecx_t *vx, unsigned data0, unsigned data1)
+{
+	hle_flags (vx, HLE_ARITH, 1, data0, ~data1, data0 + ~data1 + 1, 0);
+
+	return (data0 - data1) & 0xff;
+}
+
+static unsigned hle_sub16 (vecx_t *vx, unsigned data0, unsigned data1)
+{
+	hle_flags (vx, HLE_N | HLE_Z | HLE_V | HLE_C, 1, data0, ~data1, data0 + ~data1 + 1, 8);
+
+	return (data0 - data1) & 0xffff;
+}
+
+/* instructions touching memory, n is their cycle count */
+
+static void hle_st8 (vecx_t *vx, unsigned address, unsigned data, unsigned n)
+{
+	hle_write (vx, address, data);
+	hle_nz (vx, data, 0);
+	hle_op (vx, n);
+}
+
+static void hle_ldd (vecx_t *vx, unsigned address, unsigned n)
+{
+	vx->hle.a = hle_read (vx, address);
+	vx->hle.b = hle_read (vx, address + 1);
+	hle_nz (vx, (vx->hle.a << 8) | vx->hle.b, 8);
+	hle_op (vx, n);
+}
+
+static void hle_clr (vecx_t *vx, unsigned address, unsigned n)
+{
+	hle_write (vx, address, 0);
+	vx->hle.cc = (vx->hle.cc & ~(HLE_N | HLE_V | HLE_C)) | HLE_Z;
+	hle_op (vx, n);
+}
+
+static void hle_inc (vecx_t *vx, unsigned address, unsigned n)
+{
+	unsigned data;
+
+	data = hle_read (vx, address);
+	hle_flags (vx, HLE_N | HLE_Z | HLE_V, 0, data, 1, data + 1, 0);
+	hle_write (vx, address, data + 1);
+	hle_op (vx, n);
+}
+
+static void hle_dec (vecx_t *vx, unsigned address, unsigned n)
+{
+	hle_write (vx, address, hle_dec8 (vx, hle_read (vx, address)));
+	hle_op (vx, n);
+}
+
+static void hle_neg (vecx_t *vx, unsigned address, unsigned n)
+{
+	hle_write (vx, address, hle_sub8 (vx, 0, hle_read (vx, address)));
+	hle_op (vx, n);
+}
+
+/* register only instructions */
+
+static void hle_lda (vecx_t *vx, unsigned data, unsigned n)
+{
+	vx->hle.a = data;
+	hle_nz (vx, data, 0);
+	hle_op (vx, n);
+}
+
+static void hle_ldb (vecx_t *vx, unsigned data, unsigned n)
+{
+	vx->hle.b = data;
+	hle_nz (vx, data, 0);
+	hle_op (vx, n);
+}
+
+static void hle_ldd_imm (vecx_t *vx, unsigned data)
+{
+	vx->hle.a = data >> 8;
+	vx->hle.b = data & 0xff;
+	hle_nz (vx, data, 8);
+	hle_op (vx, 3);
+}
+
+static void hle_leax (vecx_t *vx, unsigned offset)
+{
+	vx->hle.x = (vx->hle.x + offset) & 0xffff;
+	vx->hle.cc = (vx->hle.cc & ~HLE_Z) | (vx->hle.x == 0) * HLE_Z;
+	hle_op (vx, 5);
+}
+
+/* jsr/bsr and rts */
+
+static void hle_call (vecx_t *vx, unsigned ret, unsigned n)
+{
+	hle_push8 (vx, ret & 0xff);
+	hle_push8 (vx, ret >> 8);
+	hle_op (vx, n);
+}
+
+static void hle_rts (vecx_t *vx)
+{
+	vx->hle.pc = hle_pull8 (vx) << 8;
+	vx->hle.pc |= hle_pull8 (vx);
+	hle_op (vx, 5);
+}
+
+/* bitb <$0d ; beq back to it, at pc, until a bit of b shows up in the
+ * interrupt flags. the flags only change at a via event, so rather than
+ * polling every 7 cycles skip to the first pass that sees it. returns 0,
+ * leaving the cpu at pc, if no event that raises the flags is coming.
+ */
+
+static int hle_wait (vecx_t *vx, unsigned pc)
+{
+	unsigned d, n;
+
+	for (;;) {
+		hle_nz (vx, vx->hle.b & hle_read (vx, HLE_IO (0xd)), 0);
+		hle_op (vx, 4);
+		hle_op (vx, 3);
+
+		if ((vx->hle.cc & HLE_Z) == 0) {
+			return 1;
+		}
+
+		cpu_sync (vx, vx->hle_base + vx->hle_t);
+
+		if (vx->via_ifr & vx->hle.b) {
+			continue;
+		}
+
+		d = via_next (vx, vx->hle.b & 0x7f);
+
+		if (d == ~0u) {
+			vx->hle.pc = pc;
+			return 0;
+		}
+
+		/* passes reading the flags d or more cycles from now see them,
+		 * skip the ones that certainly come before that.
+		 */
+
+		for (n = (d - 1) / 7; n > 0; n--) {
+			hle_op (vx, 4);
+			hle_op (vx, 3);
+		}
+	}
+}
+
+/* f584 abs_a_b, called with jsr */
+
+static void hle_abs_a_b (vecx_t *vx)
+{
+	hle_nz (vx, vx->hle.a, 0);
+	hle_op (vx, 2);
+	hle_op (vx, 3);
+
+	if (vx->hle.cc & HLE_N) {
+		vx->hle.a = hle_sub8 (vx, 0, vx->hle.a);
+		hle_op (vx, 2);
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & HLE_V) {
+			vx->hle.a = hle_dec8 (vx, vx->hle.a);
+			hle_op (vx, 2);
+		}
+	}
+
+	hle_nz (vx, vx->hle.b, 0);
+	hle_op (vx, 2);
+	hle_op (vx, 3);
+
+	if (vx->hle.cc & HLE_N) {
+		vx->hle.b = hle_sub8 (vx, 0, vx->hle.b);
+		hle_op (vx, 2);
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & HLE_V) {
+			vx->hle.b = hle_dec8 (vx, vx->hle.b);
+			hle_op (vx, 2);
+		}
+	}
+
+	hle_rts (vx);
+}
+
+/* f575 delay_1, called with jsr */
+
+static void hle_delay_1 (vecx_t *vx)
+{
+	hle_ldb (vx, 0x01, 2);
+	hle_op (vx, 3);
+
+	do {
+		vx->hle.b = hle_dec8 (vx, vx->hle.b);
+		hle_op (vx, 2);
+		hle_op (vx, 3);
+	} while ((vx->hle.cc & HLE_N) == 0);
+
+	hle_rts (vx);
+}
+
+/* f318, the part of the moveto routines after d has been pushed. starts
+ * timer 1 with the move under way and waits for it to run out, plus a few
+ * extra passes round a delay loop for long moves.
+ */
+
+static int hle_moveto (vecx_t *vx)
+{
+	hle_lda (vx, 0xce, 2);
+	hle_st8 (vx, HLE_IO (0xc), vx->hle.a, 4);
+	hle_clr (vx, HLE_IO (0xa), 6);
+	hle_inc (vx, HLE_IO (0x0), 6);
+	hle_st8 (vx, HLE_IO (0x1), vx->hle.b, 4);
+	hle_clr (vx, HLE_IO (0x5), 6);
+
+	vx->hle.a = hle_pull8 (vx);
+	vx->hle.b = hle_pull8 (vx);
+	hle_op (vx, 7);
+
+	hle_call (vx, 0xf329, 8);
+	hle_abs_a_b (vx);
+
+	hle_st8 (vx, vx->hle.s - 1, vx->hle.b, 5);
+	vx->hle.a |= hle_read (vx, vx->hle.s - 1);
+	hle_nz (vx, vx->hle.a, 0);
+	hle_op (vx, 5);
+
+	hle_ldb (vx, 0x40, 2);
+	hle_sub8 (vx, vx->hle.a, 0x40);
+	hle_op (vx, 2);
+	hle_op (vx, 3);
+
+	if (vx->hle.cc & (HLE_C | HLE_Z)) {
+		if (!hle_wait (vx, 0xf345)) {
+			return 0;
+		}
+	} else {
+		hle_sub8 (vx, vx->hle.a, 0x64);
+		hle_op (vx, 2);
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & (HLE_C | HLE_Z)) {
+			hle_lda (vx, 0x04, 2);
+		} else {
+			hle_lda (vx, 0x08, 2);
+			hle_op (vx, 3);
+		}
+
+		if (!hle_wait (vx, 0xf33d)) {
+			return 0;
+		}
+
+		do {
+			vx->hle.a = hle_dec8 (vx, vx->hle.a);
+			hle_op (vx, 2);
+			hle_op (vx, 3);
+		} while ((vx->hle.cc & HLE_Z) == 0);
+	}
+
+	hle_rts (vx);
+
+	return 1;
+}
+
+/* f312 moveto_d */
+
+static int hle_moveto_d (vecx_t *vx)
+{
+	hle_st8 (vx, HLE_IO (0x1), vx->hle.a, 4);
+	hle_clr (vx, HLE_IO (0x0), 6);
+
+	hle_push8 (vx, vx->hle.b);
+	hle_push8 (vx, vx->hle.a);
+	hle_op (vx, 7);
+
+	return hle_moveto (vx);
+}
+
+/* f34f, the common exit of the drawing routines. zeroes the beam unless
+ * $c824 is clear. entered at f354 it always does.
+ */
+
+static void hle_exit (vecx_t *vx, unsigned pc)
+{
+	if (pc == 0xf34f) {
+		hle_lda (vx, hle_read (vx, 0xc824), 5);
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & HLE_Z) {
+			hle_rts (vx);
+			return;
+		}
+	}
+
+	hle_ldd_imm (vx, 0x00cc);
+	hle_st8 (vx, HLE_IO (0xc), vx->hle.b, 4);
+	hle_st8 (vx, HLE_IO (0xa), vx->hle.a, 4);
+	hle_ldd_imm (vx, 0x0302);
+	hle_clr (vx, HLE_IO (0x1), 6);
+	hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+	hle_st8 (vx, HLE_IO (0x0), vx->hle.b, 4);
+	hle_st8 (vx, HLE_IO (0x0), vx->hle.b, 4);
+	hle_ldb (vx, 0x01, 2);
+	hle_st8 (vx, HLE_IO (0x0), vx->hle.b, 4);
+	hle_rts (vx);
+}
+
+/* the line loop shared by draw_vlc and draw_vl_mode. pc is where it is
+ * entered: f3da stores the line count, f3dd draws a line, f3bc moves.
+ */
+
+static int hle_lines (vecx_t *vx, unsigned pc)
+{
+	for (;;) {
+		if (pc == 0xf3da) {
+			hle_st8 (vx, 0xc823, vx->hle.a, 5);
+		}
+
+		hle_ldd (vx, vx->hle.x, 5);
+		hle_st8 (vx, HLE_IO (0x1), vx->hle.a, 4);
+		hle_clr (vx, HLE_IO (0x0), 6);
+		hle_leax (vx, 2);
+		hle_op (vx, 2);
+		hle_inc (vx, HLE_IO (0x0), 6);
+		hle_st8 (vx, HLE_IO (0x1), vx->hle.b, 4);
+
+		if (pc == 0xf3bc) {
+			hle_ldd_imm (vx, 0x0000);
+			hle_op (vx, 3);
+		} else {
+			hle_ldd_imm (vx, 0xff00);
+		}
+
+		hle_st8 (vx, HLE_IO (0xa), vx->hle.a, 4);
+		hle_st8 (vx, HLE_IO (0x5), vx->hle.b, 4);
+		hle_ldd_imm (vx, 0x0040);
+
+		if (!hle_wait (vx, 0xf3f4)) {
+			return 0;
+		}
+
+		hle_op (vx, 2);
+		hle_st8 (vx, HLE_IO (0xa), vx->hle.a, 4);
+		hle_lda (vx, hle_read (vx, 0xc823), 5);
+		vx->hle.a = hle_dec8 (vx, vx->hle.a);
+		hle_op (vx, 2);
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & HLE_N) {
+			break;
+		}
+
+		pc = 0xf3da;
+	}
+
+	hle_op (vx, 4);
+	hle_exit (vx, 0xf34f);
+
+	return 1;
+}
+
+/* f3ce draw_vlc */
+
+static int hle_draw_vlc (vecx_t *vx)
+{
+	hle_lda (vx, hle_read (vx, vx->hle.x), 6);
+	vx->hle.x = (vx->hle.x + 1) & 0xffff;
+	hle_op (vx, 3);
+
+	return hle_lines (vx, 0xf3da);
+}
+
+/* f437, a patterned line of draw_vl_mode, called with bsr. goes on to the
+ * next one while $c823 counts down.
+ */
+
+static int hle_pattern (vecx_t *vx)
+{
+	for (;;) {
+		hle_ldd (vx, vx->hle.x, 5);
+		hle_st8 (vx, HLE_IO (0x1), vx->hle.a, 4);
+		hle_clr (vx, HLE_IO (0x0), 6);
+		hle_leax (vx, 2);
+		hle_inc (vx, HLE_IO (0x0), 6);
+		hle_st8 (vx, HLE_IO (0x1), vx->hle.b, 4);
+		hle_lda (vx, hle_read (vx, 0xc829), 5);
+		hle_ldb (vx, 0x40, 2);
+		hle_st8 (vx, HLE_IO (0xa), vx->hle.a, 4);
+		hle_clr (vx, HLE_IO (0x5), 6);
+
+		hle_nz (vx, vx->hle.b & hle_read (vx, HLE_IO (0xd)), 0);
+		hle_op (vx, 5);
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & HLE_Z) {
+			/* keep feeding the pattern to the shift register until the
+			 * line is done.
+			 */
+
+			for (;;) {
+				hle_st8 (vx, HLE_IO (0xa), vx->hle.a, 4);
+				hle_op (vx, 2);
+				hle_nz (vx, vx->hle.b & hle_read (vx, HLE_IO (0xd)), 0);
+				hle_op (vx, 4);
+				hle_op (vx, 3);
+
+				if ((vx->hle.cc & HLE_Z) == 0) {
+					break;
+				}
+
+				cpu_sync (vx, vx->hle_base + vx->hle_t);
+
+				if ((vx->via_ifr & vx->hle.b) == 0 && via_next (vx, vx->hle.b & 0x7f) == ~0u) {
+					vx->hle.pc = 0xf459;
+					return 0;
+				}
+
+				hle_lda (vx, hle_read (vx, 0xc829), 5);
+			}
+
+			hle_lda (vx, hle_read (vx, 0xc823), 5);
+			hle_clr (vx, HLE_IO (0xa), 6);
+			hle_nz (vx, vx->hle.a, 0);
+			hle_op (vx, 2);
+			hle_op (vx, 3);
+
+			if (vx->hle.cc & HLE_Z) {
+				hle_op (vx, 4);
+				hle_exit (vx, 0xf34f);
+				return 1;
+			}
+		} else {
+			hle_clr (vx, HLE_IO (0xa), 6);
+			hle_lda (vx, hle_read (vx, 0xc823), 5);
+			hle_op (vx, 3);
+
+			if (vx->hle.cc & HLE_Z) {
+				hle_rts (vx);
+				return 1;
+			}
+		}
+
+		vx->hle.a = hle_dec8 (vx, vx->hle.a);
+		hle_op (vx, 2);
+		hle_st8 (vx, 0xc823, vx->hle.a, 5);
+	}
+}
+
+/* f46e draw_vl_mode */
+
+static int hle_draw_vl_mode (vecx_t *vx)
+{
+	hle_lda (vx, hle_read (vx, 0xc824), 5);
+	hle_push8 (vx, vx->hle.a);
+	hle_op (vx, 6);
+	hle_clr (vx, 0xc824, 7);
+
+	for (;;) {
+		hle_lda (vx, hle_read (vx, vx->hle.x), 6);
+		vx->hle.x = (vx->hle.x + 1) & 0xffff;
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & HLE_N) {
+			hle_call (vx, 0xf47c, 7);
+
+			if (!hle_pattern (vx)) {
+				return 0;
+			}
+		} else {
+			hle_op (vx, 3);
+
+			if (vx->hle.cc & HLE_Z) {
+				hle_call (vx, 0xf483, 8);
+
+				if (!hle_lines (vx, 0xf3bc)) {
+					return 0;
+				}
+			} else {
+				vx->hle.a = hle_dec8 (vx, vx->hle.a);
+				hle_op (vx, 2);
+				hle_op (vx, 3);
+
+				if (vx->hle.cc & HLE_Z) {
+					break;
+				}
+
+				hle_call (vx, 0xf48b, 8);
+
+				if (!hle_lines (vx, 0xf3dd)) {
+					return 0;
+				}
+			}
+		}
+
+		hle_op (vx, 3);
+	}
+
+	vx->hle.a = hle_pull8 (vx);
+	hle_op (vx, 6);
+	hle_st8 (vx, 0xc824, vx->hle.a, 5);
+	hle_op (vx, 4);
+	hle_exit (vx, 0xf34f);
+
+	return 1;
+}
+
+/* f495 print_str. the string at u is drawn as 7 rows of dots, each row
+ * shifted out of the via shift register one character at a time from the
+ * font at f9d4.
+ */
+
+static void hle_print_str (vecx_t *vx)
+{
+	unsigned data;
+
+	hle_write (vx, 0xc82c, vx->hle.u >> 8);
+	hle_write (vx, 0xc82d, vx->hle.u);
+	hle_nz (vx, vx->hle.u, 8);
+	hle_op (vx, 6);
+
+	vx->hle.x = 0xf9d4;
+	hle_nz (vx, vx->hle.x, 8);
+	hle_op (vx, 3);
+	hle_ldd_imm (vx, 0x1883);
+	hle_clr (vx, HLE_IO (0x1), 6);
+	hle_st8 (vx, HLE_IO (0xb), vx->hle.a, 4);
+	vx->hle.x = 0xf9d4;
+	hle_nz (vx, vx->hle.x, 8);
+	hle_op (vx, 3);
+
+	for (;;) {
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.b, 4);
+		hle_dec (vx, HLE_IO (0x0), 6);
+		hle_ldd_imm (vx, 0x8081);
+		hle_op (vx, 2);
+		hle_inc (vx, HLE_IO (0x0), 6);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.b, 4);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+		hle_nz (vx, hle_read (vx, 0xc800), 0);
+		hle_op (vx, 7);
+		hle_inc (vx, HLE_IO (0x0), 6);
+		hle_lda (vx, hle_read (vx, 0xc82b), 5);
+		hle_st8 (vx, HLE_IO (0x1), vx->hle.a, 4);
+		hle_ldd_imm (vx, 0x0100);
+		vx->hle.u = (hle_read (vx, 0xc82c) << 8) | hle_read (vx, 0xc82d);
+		hle_nz (vx, vx->hle.u, 8);
+		hle_op (vx, 6);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+		hle_op (vx, 3);
+
+		for (;;) {
+			hle_lda (vx, hle_read (vx, vx->hle.u), 6);
+			vx->hle.u = (vx->hle.u + 1) & 0xffff;
+			hle_op (vx, 3);
+
+			if (vx->hle.cc & HLE_N) {
+				break;
+			}
+
+			data = vx->hle.x + (vx->hle.a ^ 0x80) - 0x80;
+			hle_lda (vx, hle_read (vx, data), 5);
+			hle_st8 (vx, HLE_IO (0xa), vx->hle.a, 4);
+		}
+
+		hle_lda (vx, 0x81, 2);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+		hle_neg (vx, HLE_IO (0x1), 6);
+		hle_lda (vx, 0x01, 2);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+		hle_sub16 (vx, vx->hle.x, 0xfbb4);
+		hle_op (vx, 4);
+		hle_op (vx, 3);
+
+		if (vx->hle.cc & HLE_Z) {
+			break;
+		}
+
+		hle_leax (vx, 80);
+
+		vx->hle.a = vx->hle.u >> 8;
+		vx->hle.b = vx->hle.u & 0xff;
+		hle_op (vx, 6);
+
+		data = hle_sub16 (vx, (vx->hle.a << 8) | vx->hle.b,
+						  (hle_read (vx, 0xc82c) << 8) | hle_read (vx, 0xc82d));
+		vx->hle.a = data >> 8;
+		vx->hle.b = data & 0xff;
+		hle_op (vx, 7);
+		vx->hle.b = hle_sub8 (vx, vx->hle.b, 0x02);
+		hle_op (vx, 2);
+		hle_flags (vx, HLE_ARITH, 0, vx->hle.b, vx->hle.b, vx->hle.b + vx->hle.b, 0);
+		vx->hle.b = (vx->hle.b << 1) & 0xff;
+		hle_op (vx, 2);
+		hle_op (vx, 3);
+
+		do {
+			hle_lda (vx, 0x81, 2);
+			hle_op (vx, 2);
+			vx->hle.b = hle_dec8 (vx, vx->hle.b);
+			hle_op (vx, 2);
+			hle_op (vx, 3);
+		} while ((vx->hle.cc & HLE_Z) == 0);
+
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+		hle_ldb (vx, hle_read (vx, 0xc82a), 5);
+		hle_st8 (vx, HLE_IO (0x1), vx->hle.b, 4);
+		hle_dec (vx, HLE_IO (0x0), 6);
+		hle_ldd_imm (vx, 0x8101);
+		hle_op (vx, 2);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+		hle_clr (vx, HLE_IO (0x1), 6);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.b, 4);
+		hle_st8 (vx, HLE_IO (0x0), vx->hle.a, 4);
+		hle_ldb (vx, 0x03, 2);
+		hle_op (vx, 3);
+	}
+
+	hle_lda (vx, 0x98, 2);
+	hle_st8 (vx, HLE_IO (0xb), vx->hle.a, 4);
+	hle_op (vx, 4);
+	hle_exit (vx, 0xf354);
+}
+
+/* f37a print_str_d */
+
+static int hle_print_str_d (vecx_t *vx)
+{
+	hle_call (vx, 0xf37d, 8);
+
+	hle_st8 (vx, HLE_IO (0x1), vx->hle.a, 4);
+	hle_push8 (vx, vx->hle.b);
+	hle_push8 (vx, vx->hle.a);
+	hle_op (vx, 7);
+	hle_lda (vx, 0x7f, 2);
+	hle_st8 (vx, HLE_IO (0x4), vx->hle.a, 4);
+	hle_clr (vx, HLE_IO (0x0), 6);
+	hle_op (vx, 3);
+
+	if (!hle_moveto (vx)) {
+		return 0;
+	}
+
+	hle_call (vx, 0xf380, 8);
+	hle_delay_1 (vx);
+	hle_op (vx, 4);
+	hle_print_str (vx);
+
+	return 1;
+}
+
+/* is the rom the stock bios the routines above were written from? */
+
+static int hle_stock (vecx_t *vx)
+{
+	unsigned long h;
+	unsigned r;
+
+	h = 0x811c9dc5ul;
+
+	if (vx->rom == NULL || vx->rom->size != 8192) {
+		return 0;
+	}
+
+	for (r = 0; r < vx->rom->size; r++) {
+		h = ((h ^ vx->rom->data[r]) * 0x01000193ul) & 0xfffffffful;
+	}
+
+	return h == HLE_BIOS_HASH;
+}
+
+/* stand in for the cpu at a bios entry point given to e6809_hle_pc */
+
+static unsigned cpu_hle (void *user, unsigned cycles)
+{
+	vecx_t *vx = (vecx_t *) user;
+	int done;
+
+	e6809_get_regs (&vx->cpu, &vx->hle);
+
+	if ((vx->hle.cc & (HLE_I | HLE_F)) != (HLE_I | HLE_F) || vx->hle.dp != 0xd0) {
+		/* an interrupt could cut in, or the via is not in the direct page */
+
+		return 0;
+	}
+
+	vx->hle_base = cycles;
+	vx->hle_t = 0;
+
+	/* a routine runs to its end however far past the budget of the cpu run
+	 * that takes. vecx_emu carries the overrun into its next call. a
+	 * routine that finds no via event coming where it waits for one stops
+	 * there instead, leaving the cpu to go on polling at hle.pc.
+	 */
+
+	switch (vx->hle.pc) {
+	case 0xf312:
+		done = hle_moveto_d (vx);
+		break;
+	case 0xf37a:
+		done = hle_print_str_d (vx);
+		break;
+	case 0xf3ce:
+		done = hle_draw_vlc (vx);
+		break;
+	case 0xf46e:
+		done = hle_draw_vl_mode (vx);
+		break;
+	default:
+		return 0;
+	}
+
+	e6809_set_regs (&vx->cpu, &vx->hle);
+
+	vx->hle_calls++;
+
+	if (!done) {
+		vx->hle_stalls++;
+	}
+
+	return vx->hle_t;
+}
+
+/* emulate for the given number of cycles and return how many were actually
+ * run. the last instruction, or a bios routine emulated at a high level,
+ * may run past the end. the excess is returned now and taken off the next
+ * call, so a host asking for a fixed number of cycles per tick keeps to
+ * real time.
+ */
+
+long vecx_emu (vecx_t *vx, long cycles, int ahead)
+{
+	unsigned icycles, budget, next;
+	long run;
+
+	run = 0;
+
+	if (vx->emu_over >= cycles) {
+		vx->emu_over -= cycles;
+		return 0;
+	}
+
+	cycles -= vx->emu_over;
+
+	while (cycles > 0) {
+		/* the cpu runs ahead of the via and analog hardware until it
+		 * touches io, the next via event that may raise an enabled
+		 * interrupt is due or the frame ends. the hardware then catches
+		 * up.
+		 */
+
+		budget = (unsigned) (vx->fcycles < cycles ? vx->fcycles : cycles);
+
+		if (vx->lockstep) {
+			next = 1;
+		} else {
+			next = via_next (vx, vx->via_ier);
+
+			if (next > budget) {
+				next = budget + 1;
+			}
+		}
+
+		icycles = e6809_run (&vx->cpu, budget, vx->cpu.cycles + next);
+
+		if (icycles > vx->sync_cycles) {
+			hw_run (vx, icycles - vx->sync_cycles);
+		}
+
+		vx->sync_cycles = 0;
+
+		cycles -= (long) icycles;
+		run += (long) icycles;
+
+		vx->fcycles -= (long) icycles;
+
+		if (vx->fcycles < 0) {
+			vx->fcycles += FCYCLES_INIT;
+			frame_end (vx);
+		}
+	}
+
+	vx->emu_over = -cycles;
+
+	return run;
 }
@@ -1,40 +1,347 @@
 #ifndef __VECX_H
 #define __VECX_H
 
+#include "atomics.h"
+#include "e6809.h"
+
 enum {
 	VECTREX_MHZ		= 1500000, /* speed of the vectrex being emulated */
 	VECTREX_COLORS  = 128,     /* number of possible colors ... grayscale */
 
 	ALG_MAX_X		= 33000,
-	ALG_MAX_Y		= 41000
+	ALG_MAX_Y		= 41000,
+
+	VECTREX_PDECAY	= 30,      /* phosphor decay rate */
+
+	/* number of 6809 cycles before a frame redraw */
+
+	FCYCLES_INIT    = VECTREX_MHZ / VECTREX_PDECAY,
+
+	/* max number of possible vectors that maybe on the screen at one time. */
+
+	VECTOR_CNT		= VECTREX_MHZ / VECTREX_PDECAY,
+
+	/* vectors a frame has room for when it is first drawn into. the lists
+	 * double from there as needed, up to VECTOR_CNT.
+	 */
+
+	VECTOR_MIN		= 256,
+
+	/* number of frame buffers. one is being drawn into by the emulator, the
+	 * rest may be held by frame consumers. a triple buffered render thread
+	 * holds at most two, so it never causes a dropped frame.
+	 */
+
+	FRAME_CNT		= 4,
+
+	/* idle loop starts a host may give */
+
+	IDLE_PC_CNT		= 16,
+
+	/* dedupe table. a power of two at least VECTOR_HASH_LOAD times the
+	 * room in the largest draw list, so probe runs stay short.
+	 */
+
+	VECTOR_HASH_LOAD = 4,
+	VECTOR_PROBE    = 8,       /* slots tried per lookup */
+
+	/* coordinate of the end points of a free slot in a live vector set,
+	 * off screen in both directions.
+	 */
+
+	VECTOR_PARKED   = 0xffff
 };
 
-typedef struct vector_type {
-	long x0, y0; /* start coordinate */
-	long x1, y1; /* end coordinate */
+/* a vector list as a structure of arrays, vector i running from (x0[i],
+ * y0[i]) to (x1[i], y1[i]) in color[i] [0, VECTREX_COLORS - 1]. vectors
+ * only exist on screen, so coordinates are in [0, ALG_MAX_X) and
+ * [0, ALG_MAX_Y) and fit 16 bits.
+ */
+
+typedef struct vecx_vlist {
+	unsigned short *x0, *y0;
+	unsigned short *x1, *y1;
+	unsigned char *color;
+} vecx_vlist_t;
+
+/* dedupe table slot. only slots tagged with the current generation are in
+ * use, so bumping the generation empties the table.
+ */
+
+typedef struct vecx_vslot {
+	unsigned gen;
+	unsigned index; /* into the draw list */
+} vecx_vslot_t;
+
+/* a finished frame. the vector list is read-only once the frame has been
+ * handed out and stays valid until the last reference is released.
+ */
+
+typedef struct vecx_frame {
+	const unsigned short *x0, *y0;
+	const unsigned short *x1, *y1;
+	const unsigned char *color;
+	long cnt;
+	long cap; /* vectors the list has room for */
+	unsigned long number; /* frames since reset */
+	volatile long refs;
+} vecx_frame_t;
+
+typedef void (*vecx_frame_fn) (vecx_frame_t *frame, void *user);
+
+/* lock-free triple buffer for passing frames from the emulation thread to a
+ * render thread. the emulator draws into the back buffer, publishing swaps
+ * it into the middle slot and the render thread takes the middle slot as
+ * its front buffer, so neither side ever waits for or copies the other.
+ */
+
+typedef struct vecx_tribuf {
+	void * volatile middle;
+} vecx_tribuf_t;
+
+/* the vectors on screen, kept by a frame consumer from one frame to the
+ * next. a vector keeps the slot it was given when it appeared for as long
+ * as it stays on screen, so a renderer that mirrors the slots (in a vertex
+ * buffer, say) only needs to update those that changed. a slot that is
+ * freed is parked as a zero length vector at VECTOR_PARKED and handed out
+ * again before any new one. the consumer zeroes it before the first
+ * vecx_live_update and calls vecx_live_done once it is finished with it.
+ */
+
+typedef struct vecx_live {
+	unsigned short *x0, *y0;
+	unsigned short *x1, *y1;
+	unsigned char *color;
+	long cnt;   /* slots handed out, live or parked */
+	long cap;
+	long live;  /* slots holding a vector on screen */
+
+	/* slots changed since the last vecx_live_clean are in [dirty_lo,
+	 * dirty_hi).
+	 */
+
+	long dirty_lo;
+	long dirty_hi;
+
+	/* what the last update did */
+
+	long added;
+	long removed;
+	long recolored;
+
+	/* private to vecx.c */
+
+	unsigned long gen;
+	unsigned long *seen;  /* generation a slot was last seen in, 0 if parked */
+	long *free_slot;
+	long free_cnt;
+	long *pend;           /* vectors of the frame not yet on screen */
+	long pend_cap;
+	unsigned *map;        /* slot + 1 by end points, 0 for empty */
+	unsigned map_bits;
+} vecx_live_t;
+
+/* a read-only rom image (bios or cartridge). any number of instances may
+ * share one. it is reference counted, and an image loaded from a file is
+ * mapped straight from it rather than copied. reads past the end of an
+ * image return 0.
+ */
+
+typedef struct vecx_image {
+	const unsigned char *data;
+	unsigned long size;
+	unsigned long span;		/* bytes readable at data, zero past size */
+	volatile long refs;
+	void *map;				/* base of the file mapping, NULL for wrapped memory */
+	unsigned long map_size;
+} vecx_image_t;
+
+vecx_image_t *vecx_image_map (const char *filename, unsigned long max);
+vecx_image_t *vecx_image_wrap (const unsigned char *data, unsigned long size);
+void vecx_image_retain (vecx_image_t *img);
+void vecx_image_release (vecx_image_t *img);
+
+/* one complete vectrex. instances share nothing, so any number of them can
+ * be emulated side by side, each on one thread at a time. the host zeroes
+ * it, gives it a bios (and optionally a cartridge) image, sets the options
+ * and calls vecx_reset, and calls vecx_done once it is finished with it,
+ * after releasing any frames it still holds. the hot via and analog state
+ * comes first, the big buffers last.
+ */
+
+typedef struct vecx {
+	/* the via 6522 registers */
 
-	/* color [0, VECTREX_COLORS - 1], if color = VECTREX_COLORS, then this is
-	 * an invalid entry and must be ignored.
+	unsigned via_ora;
+	unsigned via_orb;
+	unsigned via_ddra;
+	unsigned via_ddrb;
+	unsigned via_t1on;  /* is timer 1 on? */
+	unsigned via_t1int; /* are timer 1 interrupts allowed? */
+	unsigned via_t1c;
+	unsigned via_t1ll;
+	unsigned via_t1lh;
+	unsigned via_t1pb7; /* timer 1 controlled version of pb7 */
+	unsigned via_t2on;  /* is timer 2 on? */
+	unsigned via_t2int; /* are timer 2 interrupts allowed? */
+	unsigned via_t2c;
+	unsigned via_t2ll;
+	unsigned via_sr;
+	unsigned via_srb;   /* number of bits shifted so far */
+	unsigned via_src;   /* shift counter */
+	unsigned via_srclk;
+	unsigned via_acr;
+	unsigned via_pcr;
+	unsigned via_ifr;
+	unsigned via_ier;
+	unsigned via_ca2;
+	unsigned via_cb2h;  /* basic handshake version of cb2 */
+	unsigned via_cb2s;  /* version of cb2 controlled by the shift register */
+
+	/* analog devices */
+
+	unsigned alg_rsh;  /* zero ref sample and hold */
+	unsigned alg_xsh;  /* x sample and hold */
+	unsigned alg_ysh;  /* y sample and hold */
+	unsigned alg_zsh;  /* z sample and hold */
+	unsigned alg_jch0; /* joystick direction channel 0 */
+	unsigned alg_jch1; /* joystick direction channel 1 */
+	unsigned alg_jch2; /* joystick direction channel 2 */
+	unsigned alg_jch3; /* joystick direction channel 3 */
+	unsigned alg_jsh;  /* joystick sample and hold */
+
+	unsigned alg_compare;
+
+	long alg_dx;     /* delta x */
+	long alg_dy;     /* delta y */
+	long alg_curr_x; /* current x position */
+	long alg_curr_y; /* current y position */
+
+	unsigned alg_vectoring; /* are we drawing a vector right now? */
+	long alg_vector_x0;
+	long alg_vector_y0;
+	long alg_vector_x1;
+	long alg_vector_y1;
+	long alg_vector_dx;
+	long alg_vector_dy;
+	unsigned char alg_vector_color;
+
+	/* the sound chip registers */
+
+	unsigned snd_regs[16];
+	unsigned snd_select;
+
+	long fcycles;
+
+	/* cycles of the current cpu run that cpu_sync already emulated */
+
+	unsigned sync_cycles;
+
+	/* cycles the last vecx_emu ran past what it was asked for, by the
+	 * last instruction or a high level routine crossing the end. the next
+	 * call runs that many fewer.
+	 */
+
+	long emu_over;
+
+	/* step the hardware after every instruction rather than letting it lag
+	 * behind the cpu, for checking the catch-up scheduling against.
+	 */
+
+	int lockstep;
+
+	/* emulate the bios drawing routines at a high level */
+
+	int hle_enable;
+
+	/* starts of idle loops in the cartridge, handed to the cpu on reset */
+
+	unsigned idle_pc[IDLE_PC_CNT];
+	unsigned idle_pc_cnt;
+
+	e6809_regs_t hle;  /* cpu registers while a routine runs */
+	unsigned hle_base; /* cycles the cpu run had used before the routine */
+	unsigned hle_t;    /* cycles into the routine */
+
+	/* routines emulated since reset, and those of them that stopped at a
+	 * wait loop with no via event coming for the cpu to carry on from.
 	 */
-	unsigned char color;
-} vector_t;
 
-extern unsigned char rom[8192];
-extern unsigned char cart[32768];
+	unsigned long hle_calls;
+	unsigned long hle_stalls;
+
+	/* frames */
+
+	long vector_draw_cnt;
+	vecx_vlist_t vectors_draw; /* writable view of frame_draw's list */
+
+	vecx_frame_t *frame_draw;
+	unsigned long frame_number;
+	unsigned long frames_dropped;
+
+	vecx_frame_fn frame_fn;
+	void *frame_user;
+
+	vecx_frame_t frames[FRAME_CNT];
+
+	unsigned char ram[1024];
+
+	/* backing for pages that read as 0xff and for pages that ignore writes */
+
+	unsigned char page_ff[256];
+	unsigned char page_wo[256];
+
+	vecx_image_t *rom;  /* 8k bios */
+	vecx_image_t *cart; /* up to 32k, NULL for none */
+
+	e6809_t cpu;
+
+	/* lines ended since reset, those that were already in the frame and
+	 * were only recolored, and those that found no free slot and were
+	 * drawn without being looked for again.
+	 */
+
+	unsigned long vector_lines;
+	unsigned long vector_dedups;
+	unsigned long vector_spills;
+
+	/* lines dropped because a frame was full or its list could not grow,
+	 * the most vectors in any frame since reset and the bytes allocated
+	 * for the vector lists of all frames. lists never shrink, so once every
+	 * frame has seen the busiest scene no more memory is allocated.
+	 */
+
+	unsigned long vector_drops;
+	long vector_peak;
+	unsigned long vector_bytes;
+
+	/* dedupe table of 1 << vector_hash_bits slots, grown along with the
+	 * draw lists. NULL if it could not be allocated, in which case every
+	 * line spills.
+	 */
+
+	unsigned vector_gen;
+	unsigned vector_hash_bits;
+	vecx_vslot_t *vector_hash;
+} vecx_t;
+
+void vecx_set_rom (vecx_t *vx, vecx_image_t *img);
+void vecx_set_cart (vecx_t *vx, vecx_image_t *img);
+void vecx_reset (vecx_t *vx);
+void vecx_done (vecx_t *vx);
+long vecx_emu (vecx_t *vx, long cycles, int ahead);
 
-extern unsigned snd_regs[16];
-extern unsigned alg_jch0;
-extern unsigned alg_jch1;
-extern unsigned alg_jch2;
-extern unsigned alg_jch3;
+void vecx_frame_callback (vecx_t *vx, vecx_frame_fn fn, void *user);
+void vecx_frame_retain (vecx_frame_t *frame);
+void vecx_frame_release (vecx_frame_t *frame);
+unsigned long vecx_frames_dropped (vecx_t *vx);
 
-extern long vector_draw_cnt;
-extern long vector_erse_cnt;
-extern vector_t *vectors_draw;
-extern vector_t *vectors_erse;
+void vecx_tribuf_publish (vecx_tribuf_t *tb, vecx_frame_t *frame);
+vecx_frame_t *vecx_tribuf_acquire (vecx_tribuf_t *tb);
 
-void vecx_reset (void);
-void vecx_emu (long cycles, int ahead);
+long vecx_live_update (vecx_live_t *live, const vecx_frame_t *frame);
+void vecx_live_clean (vecx_live_t *live);
+void vecx_live_done (vecx_live_t *live);
 
 #endif
 